@@ -13,6 +13,14 @@ var keys = require('message_keys');
   weatherIntervalMin: 30,
   bgUnit: 'mgdl',
   bgFetchIntervalMin: 5,
+  bgStreaming: false,
+  bgAdaptive: false,   // poll between bgPollMinMin and bgPollMaxMin depending on rate and range
+  bgPollMinMin: 1,
+  bgPollMaxMin: 10,
+  bgUrgentLow: 55,      // mg/dL; watch vibrates below it (or when heading below), 0 = off
+  bgAlertSnoozeMin: 30, // repeat interval while still urgent-low
+  followers: [],        // up to two more Nightscout sites: [{ url, tag }], shown by row types 10/11
+  idleMode: false,      // blank steps/HR/seconds after 5 min without a wrist flick
     colors: {
       low: '#FF0000',
       high: '#FFFF00',
@@ -31,6 +39,10 @@ var keys = require('message_keys');
     weekdayLang: 0
   };
 
+  function isNum(v) {
+    return typeof v === 'number' && isFinite(v);
+  }
+
   function hexToInt(hex) {
     return parseInt(hex.replace('#',''), 16);
   }
@@ -39,6 +51,33 @@ var keys = require('message_keys');
   var isPebble2 = false;
   var bwPalette = ['#000000','#555555','#777777','#AAAAAA','#FFFFFF'];
   var BG_STATUS = { OK: 0, NO_DATA: 1, NO_CONN: 2 };
+  // Watch-side BgTrend enum; same numbering as Nightscout's numeric `trend` field
+  var BG_TREND = {
+    NONE: 0, DOUBLE_UP: 1, SINGLE_UP: 2, FORTY_FIVE_UP: 3, FLAT: 4,
+    FORTY_FIVE_DOWN: 5, SINGLE_DOWN: 6, DOUBLE_DOWN: 7, NOT_COMPUTABLE: 8, RATE_OUT_OF_RANGE: 9
+  };
+  var TREND_BY_DIRECTION = {
+    'doubleup': BG_TREND.DOUBLE_UP,
+    'singleup': BG_TREND.SINGLE_UP,
+    'up': BG_TREND.SINGLE_UP,
+    'fortyfiveup': BG_TREND.FORTY_FIVE_UP,
+    'flat': BG_TREND.FLAT,
+    'fortyfivedown': BG_TREND.FORTY_FIVE_DOWN,
+    'singledown': BG_TREND.SINGLE_DOWN,
+    'down': BG_TREND.SINGLE_DOWN,
+    'doubledown': BG_TREND.DOUBLE_DOWN,
+    'notcomputable': BG_TREND.NOT_COMPUTABLE,
+    'rateoutofrange': BG_TREND.RATE_OUT_OF_RANGE
+  };
+
+  // Prefer the direction name; fall back to a numeric trend as sent by /pebble
+  function trendFromReading(direction, trend) {
+    var dir = String(direction || '').toLowerCase().replace(/[\s_-]+/g, '');
+    if (TREND_BY_DIRECTION.hasOwnProperty(dir)) return TREND_BY_DIRECTION[dir];
+    var n = parseInt(trend, 10);
+    if (isFinite(n) && n > BG_TREND.NONE && n <= BG_TREND.RATE_OUT_OF_RANGE) return n;
+    return BG_TREND.NONE;
+  }
 
   function quantize(hex) {
     var palette = ['#000000','#555555','#AAAAAA','#FFFFFF','#FF0000','#FFFF00','#00FF00','#00FFFF','#0000FF','#FF00FF','#FF9900','#8000FF'];
@@ -89,6 +128,100 @@ var keys = require('message_keys');
     return out;
   }
 
+  // Every message to the watch goes through one queue with a single message in flight.
+  // Urgent messages (an urgent-low BG) are put ahead of queued weather and config
+  // traffic, so only a message already in flight can delay them.
+  var OUTBOX_TIMEOUT_MS = 10000;
+  var _outbox = { queue: [], busy: false };
+
+  function sendToWatch(dict, ok, fail, urgent) {
+    var item = { dict: dict, ok: ok, fail: fail, urgent: !!urgent };
+    if (urgent) {
+      var i = 0;
+      while (i < _outbox.queue.length && _outbox.queue[i].urgent) i++;
+      _outbox.queue.splice(i, 0, item);
+    } else {
+      _outbox.queue.push(item);
+    }
+    pumpOutbox();
+  }
+
+  function pumpOutbox() {
+    if (_outbox.busy || !_outbox.queue.length) return;
+    var item = _outbox.queue.shift();
+    var finished = false, guard = null;
+    function finish(cb, e) {
+      if (finished) return;
+      finished = true;
+      if (guard) clearTimeout(guard);
+      _outbox.busy = false;
+      try { if (cb) cb(e); } catch(_e) {}
+      pumpOutbox();
+    }
+    _outbox.busy = true;
+    // A lost ack must not stall the queue
+    guard = setTimeout(function(){ finish(item.fail); }, OUTBOX_TIMEOUT_MS);
+    try {
+      Pebble.sendAppMessage(toKeyed(item.dict), function(e){ finish(item.ok, e); }, function(e){ finish(item.fail, e); });
+    } catch(e) {
+      finish(item.fail, e);
+    }
+  }
+
+  // Companion state store: everything worth keeping across PebbleKit JS restarts (config,
+  // synced config, location, weather + forecast, BG readings and poll bookkeeping) lives in
+  // one versioned localStorage entry. Writers update a section and the whole entry is
+  // written once per STORE_FLUSH_MS batch. The separate supercgm_* keys of older
+  // versions are migrated on first load.
+  var STORE_KEY = 'supercgm_state', STORE_VERSION = 1, STORE_FLUSH_MS = 2000;
+  var LEGACY_KEYS = {
+    config: 'supercgm_config', synced: 'supercgm_synced', loc: 'supercgm_last_loc',
+    weather: 'supercgm_weather', lastBG: 'supercgm_last_bg'
+  };
+  var _store = null, _storeTimer = null;
+
+  function emptyStore() {
+    return { v: STORE_VERSION, config: null, synced: null, loc: null, weather: null, lastBG: null,
+      bgHistory: [], followers: [], bgPolledAt: 0 };
+  }
+
+  function loadStore() {
+    _store = emptyStore();
+    var saved = null;
+    try { saved = JSON.parse(localStorage.getItem(STORE_KEY) || 'null'); } catch(e) {}
+    if (saved && saved.v === STORE_VERSION) {
+      Object.keys(_store).forEach(function(k){ if (k in saved) _store[k] = saved[k]; });
+      return;
+    }
+    var migrated = false;
+    Object.keys(LEGACY_KEYS).forEach(function(k){
+      try {
+        var v = localStorage.getItem(LEGACY_KEYS[k]);
+        if (v !== null) { _store[k] = JSON.parse(v); migrated = true; }
+      } catch(e) {}
+    });
+    if (migrated) {
+      flushStore();
+      Object.keys(LEGACY_KEYS).forEach(function(k){
+        try { localStorage.removeItem(LEGACY_KEYS[k]); } catch(e) {}
+      });
+    }
+  }
+
+  function flushStore() {
+    if (_storeTimer) { clearTimeout(_storeTimer); _storeTimer = null; }
+    try { localStorage.setItem(STORE_KEY, JSON.stringify(_store)); } catch(e) {}
+  }
+
+  // now: write right away instead of with the next batch (user-initiated changes)
+  function storeSet(section, value, now) {
+    _store[section] = value;
+    if (now) flushStore();
+    else if (!_storeTimer) _storeTimer = setTimeout(flushStore, STORE_FLUSH_MS);
+  }
+
+  loadStore();
+
   function enforceBWPalette() {
     if (!config.rows || !Array.isArray(config.rows)) config.rows = normalizeRows(config.rows);
     if (!isBWPlatform) return;
@@ -116,69 +249,382 @@ var keys = require('message_keys');
     }
   }
 
-  function sendConfig() {
-    // Break into smaller messages for reliability on some phones
-    function send(dict, cb) {
-      Pebble.sendAppMessage(toKeyed(dict), function(){ if (cb) cb(); }, function(){
+  // Config sync: the full config is one flat dict of watch keys, identified by a hash.
+  // The last set the watch acknowledged is kept in the store, so later changes
+  // only send the keys that differ (with CONFIG_BASE_HASH naming the set they apply to).
+  // On launch we only ask for the watch's hash (CONFIG_QUERY) and send nothing when
+  // it already matches.
+  function buildConfigDict() {
+    config.rows = normalizeRows(config.rows);
+    var dict = {};
+    for (var i=0; i<5; i++) {
+      dict['ROW' + (i+1) + '_TYPE'] = config.rows[i].type;
+      dict['ROW' + (i+1) + '_COLOR'] = hexToInt(quantize(config.rows[i].color));
+    }
+    dict.COLOR_LOW = hexToInt(quantize(config.colors.low));
+    dict.COLOR_HIGH = hexToInt(quantize(config.colors.high));
+    dict.COLOR_IN_RANGE = hexToInt(quantize(config.colors.in));
+    dict.GHOST_COLOR = hexToInt(quantize(config.colors.ghost));
+    dict.BG_THRESH_LOW = config.low;
+    dict.BG_THRESH_HIGH = config.high;
+    dict.BG_URGENT_LOW = isNum(config.bgUrgentLow) ? config.bgUrgentLow : 55;
+    dict.BG_ALERT_SNOOZE_MIN = isNum(config.bgAlertSnoozeMin) ? config.bgAlertSnoozeMin : 30;
+    dict.BG_FOLLOW_TAGS = [0, 1].map(function(i){ return followerTag(i); }).join('');
+    dict.SHOW_LEADING_ZERO = config.showLeadingZero ? 1 : 0;
+    dict.IDLE_MODE = config.idleMode ? 1 : 0;
+    dict.DATE_FORMAT = config.dateFormat;
+    dict.WEEKDAY_LANG = config.weekdayLang;
+    dict.TEMP_UNIT = config.tempUnit === 'F' ? 1 : 0;
+    dict.WEATHER_INTERVAL_MIN = config.weatherIntervalMin;
+    dict.BG_TIMEOUT_MIN = config.bgTimeoutMin;
+    dict.BG_UNIT = config.bgUnit === 'mmol' ? 1 : 0;
+    return dict;
+  }
+
+  // FNV-1a over the sorted key=value pairs, kept positive and non-zero (0 = unknown on the watch)
+  function configHash(dict) {
+    var text = Object.keys(dict).sort().map(function(k){ return k + '=' + dict[k] + ';'; }).join('');
+    var h = 0x811c9dc5;
+    for (var i=0; i<text.length; i++) {
+      h ^= text.charCodeAt(i);
+      h = (h + (h << 1) + (h << 4) + (h << 7) + (h << 8) + (h << 24)) >>> 0;
+    }
+    h = h & 0x7fffffff;
+    return h || 1;
+  }
+
+  var _synced = _store.synced; // { hash, dict } the watch last reported holding
+  if (_synced && (!isNum(_synced.hash) || !_synced.dict)) _synced = null;
+  // { hash, dict } last sent; it becomes _synced once the watch echoes the hash. A delivered
+  // message is not enough: the watch drops a diff against a base it does not hold.
+  var _sentConfig = null;
+
+  // Config keys that differ from base (all keys without one), tagged with the hashes
+  function configMessage(base) {
+    var dict = buildConfigDict();
+    var hash = configHash(dict);
+    var msg = {};
+    Object.keys(dict).forEach(function(k){
+      if (!base || base.dict[k] !== dict[k]) msg[k] = dict[k];
+    });
+    msg.CONFIG_HASH = hash;
+    if (base) msg.CONFIG_BASE_HASH = base.hash;
+    _sentConfig = { hash: hash, dict: dict };
+    return msg;
+  }
+
+  function sendConfig(base) {
+    var msg = configMessage(base);
+    sendToWatch(msg, null, function(){
+      // one retry
+      sendToWatch(msg, null, function(){});
+    });
+  }
+
+  // The watch holds the config with this hash: remember its keys as the base for diffs
+  function noteWatchConfig(watchHash) {
+    var dict = null;
+    if (_sentConfig && _sentConfig.hash === watchHash) dict = _sentConfig.dict;
+    else if (watchHash === configHash(buildConfigDict())) dict = buildConfigDict();
+    if (!dict || (_synced && _synced.hash === watchHash)) return;
+    _synced = { hash: watchHash, dict: dict };
+    storeSet('synced', _synced);
+  }
+
+  // Ask the watch for its config hash; it only replies when it differs from ours.
+  function queryConfig() {
+    var hash = configHash(buildConfigDict());
+    sendToWatch({ 'CONFIG_HASH': hash, 'CONFIG_QUERY': 1 }, function(){}, function(){
+      sendToWatch({ 'CONFIG_HASH': hash, 'CONFIG_QUERY': 1 }, function(){}, function(){
+        sendConfig(null);
+      });
+    });
+  }
+
+  // The watch reported the hash of the config it holds: after applying a config message,
+  // or because it lacks the base of a diff.
+  function onWatchConfigHash(watchHash) {
+    noteWatchConfig(watchHash);
+    if (watchHash === configHash(buildConfigDict())) return;
+    sendConfig(_synced && _synced.hash === watchHash ? _synced : null);
+  }
+
+  // Startup snapshot: the watch's HELLO reports its config hash and the timestamps of
+  // its cached weather and BG. One reply carries whatever it is missing or behind on,
+  // straight from the phone's caches; the network is only asked for what is stale here too.
+  // The watch sends HELLO at launch; if that happened before we were up, our own HELLO
+  // asks it again. Watch builds without HELLO get the old push after HELLO_WAIT_MS.
+  var HELLO_WAIT_MS = 3000;
+  // A watch HELLO answering our ping can cross the one it sent on reconnect; the same
+  // timestamps within this window would only repeat the snapshot
+  var HELLO_DEDUPE_MS = 5000;
+  var _helloTimer = null;
+  var _lastHello = null;
+
+  function legacyStartup() {
+    _helloTimer = null;
+    queryConfig();
+    fetchWeather();
+    resumeBGPoll();
+  }
+
+  function onHello(p) {
+    if (_helloTimer) { clearTimeout(_helloTimer); _helloTimer = null; }
+    var key = [p.CONFIG_HASH, p.WEATHER_TIMESTAMP, p.BG_TIMESTAMP].join('/');
+    if (_lastHello && _lastHello.key === key && Date.now() - _lastHello.at < HELLO_DEDUPE_MS) return;
+    _lastHello = { key: key, at: Date.now() };
+    var snap = {};
+    var watchHash = isNum(p.CONFIG_HASH) ? p.CONFIG_HASH : 0;
+    noteWatchConfig(watchHash);
+    if (watchHash !== configHash(buildConfigDict())) {
+      snap = configMessage(_synced && _synced.hash === watchHash ? _synced : null);
+    }
+    var unit = config.tempUnit === 'F' ? 'F' : 'C';
+    if (_lastWeather.temp !== null && _lastWeather.unit === unit &&
+        _lastWeather.ts > (isNum(p.WEATHER_TIMESTAMP) ? p.WEATHER_TIMESTAMP : 0)) {
+      var w = weatherDict(_lastWeather, unit);
+      Object.keys(w).forEach(function(k){ snap[k] = w[k]; });
+    }
+    var bgNeeded = hasBGRow() && config.bgUrl;
+    if (bgNeeded && _lastBG && _lastBG.ts > (isNum(p.BG_TIMESTAMP) ? p.BG_TIMESTAMP : 0)) {
+      var b = bgDict(_lastBG);
+      Object.keys(b).forEach(function(k){ snap[k] = b[k]; });
+    }
+    // The watch does not keep followed readings across launches
+    var follow = [];
+    activeFollowers().forEach(function(i){
+      if (_store.followers[i]) follow = follow.concat(packFollower(i, _store.followers[i]));
+    });
+    if (follow.length) snap.BG_FOLLOW = follow;
+    if (Object.keys(snap).length) {
+      sendToWatch(snap, null, function(){
         // one retry
-        Pebble.sendAppMessage(toKeyed(dict), function(){ if (cb) cb(); }, function(){ if (cb) cb(); });
+        sendToWatch(snap, null, function(){});
       });
     }
-    // 1) Rows types/colors
-    config.rows = normalizeRows(config.rows);
-    var rowsDict = {};
-    for (var i=0; i<5; i++) {
-      rowsDict['ROW' + (i+1) + '_TYPE'] = config.rows[i].type;
-  rowsDict['ROW' + (i+1) + '_COLOR'] = hexToInt(quantize(config.rows[i].color));
-    }
-    // 2) Colors and thresholds
-    var colorsDict = {
-  'COLOR_LOW': hexToInt(quantize(config.colors.low)),
-  'COLOR_HIGH': hexToInt(quantize(config.colors.high)),
-  'COLOR_IN_RANGE': hexToInt(quantize(config.colors.in)),
-  'GHOST_COLOR': hexToInt(quantize(config.colors.ghost)),
-      'BG_THRESH_LOW': config.low,
-      'BG_THRESH_HIGH': config.high
-    };
-    // 3) Basics
-    var basicDict = {
-      'SHOW_LEADING_ZERO': config.showLeadingZero ? 1 : 0,
-      'DATE_FORMAT': config.dateFormat,
-      'WEEKDAY_LANG': config.weekdayLang,
-      'TEMP_UNIT': config.tempUnit === 'F' ? 1 : 0,
-      'WEATHER_INTERVAL_MIN': config.weatherIntervalMin,
-      'BG_TIMEOUT_MIN': config.bgTimeoutMin,
-      'BG_UNIT': config.bgUnit === 'mmol' ? 1 : 0
-    };
-    send(rowsDict, function(){ send(colorsDict, function(){ send(basicDict); }); });
+    if (!weatherCacheFresh()) fetchWeather();
+    else refreshLocationIfOld(function(moved){ if (moved) fetchWeather(); });
+    resumeBGPoll();
+  }
+
+  // Location service: one cached coarse position shared by every weather fetch.
+  // Weather always uses the last known position right away; a fix is only requested
+  // when that position is older than LOCATION_MAX_AGE_MS, and weather is refetched
+  // only when the new fix moved more than LOCATION_REFETCH_KM.
+  var LOCATION_MAX_AGE_MS = 30 * 60 * 1000;
+  var LOCATION_REFETCH_KM = 5;
+  var DEFAULT_LOCATION = { lat: 52.5200, lon: 13.4050, ts: 0 }; // Berlin
+  var _location = null;
+  var _locationPending = [];
+  var savedLoc = _store.loc;
+  if (savedLoc && isNum(savedLoc.lat) && isNum(savedLoc.lon)) {
+    _location = { lat: savedLoc.lat, lon: savedLoc.lon, ts: isNum(savedLoc.ts) ? savedLoc.ts : 0 };
+  }
+
+  function distanceKm(a, b) {
+    var rad = Math.PI / 180;
+    var dLat = (b.lat - a.lat) * rad, dLon = (b.lon - a.lon) * rad;
+    var h = Math.sin(dLat/2) * Math.sin(dLat/2) +
+      Math.cos(a.lat * rad) * Math.cos(b.lat * rad) * Math.sin(dLon/2) * Math.sin(dLon/2);
+    return 12742 * Math.atan2(Math.sqrt(h), Math.sqrt(1 - h));
+  }
+
+  // Ask for a coarse fix; done(moved) runs once it arrives or fails.
+  // Concurrent callers share one geolocation request.
+  function refreshLocation(done) {
+    _locationPending.push(done || function(){});
+    if (_locationPending.length > 1) return;
+    function finish(moved) {
+      var cbs = _locationPending;
+      _locationPending = [];
+      cbs.forEach(function(cb){ cb(moved); });
+    }
+    try {
+      navigator.geolocation.getCurrentPosition(function(pos){
+        var prev = _location;
+        _location = { lat: pos.coords.latitude, lon: pos.coords.longitude, ts: Date.now() };
+        storeSet('loc', _location);
+        finish(!prev || distanceKm(prev, _location) >= LOCATION_REFETCH_KM);
+      }, function(){
+        finish(false);
+      }, { enableHighAccuracy: false, timeout: 15000, maximumAge: LOCATION_MAX_AGE_MS });
+    } catch(e) {
+      finish(false);
+    }
   }
 
-  // Weather fetch with caching and throttling
+  function refreshLocationIfOld(done) {
+    if (_location && (Date.now() - _location.ts) < LOCATION_MAX_AGE_MS) return;
+    refreshLocation(done);
+  }
+
+  // Weather provider pipeline. Providers are tried in order, but a slow one does not
+  // block the next: once it exceeds its own p90 latency (hedge delay) the next healthy
+  // provider is started in parallel, and a failure starts it immediately. The first
+  // answer wins; late answers still feed the latency stats. A provider that failed
+  // BREAKER_THRESHOLD times in a row is skipped for BREAKER_COOLDOWN_MS, then gets
+  // one trial request again.
+  var HEDGE_DEFAULT_MS = 3000, HEDGE_MIN_MS = 1000, HEDGE_MAX_MS = 4000;
+  var LATENCY_SAMPLES = 20;
+  var BREAKER_THRESHOLD = 3, BREAKER_COOLDOWN_MS = 10 * 60 * 1000;
+  var _providerHealth = {};
+
+  function providerHealth(name) {
+    if (!_providerHealth[name]) _providerHealth[name] = { latencies: [], failures: 0, openUntil: 0 };
+    return _providerHealth[name];
+  }
+
+  function percentile(list, p) {
+    var sorted = list.slice().sort(function(a, b){ return a - b; });
+    return sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+  }
+
+  function hedgeDelay(name) {
+    var h = providerHealth(name);
+    if (h.latencies.length < 5) return HEDGE_DEFAULT_MS;
+    return Math.min(HEDGE_MAX_MS, Math.max(HEDGE_MIN_MS, percentile(h.latencies, 0.9)));
+  }
+
+  function recordProviderResult(name, ok, ms) {
+    var h = providerHealth(name);
+    if (ok) {
+      h.failures = 0;
+      h.openUntil = 0;
+      h.latencies.push(ms);
+      if (h.latencies.length > LATENCY_SAMPLES) h.latencies.shift();
+    } else if (++h.failures >= BREAKER_THRESHOLD) {
+      h.openUntil = Date.now() + BREAKER_COOLDOWN_MS;
+      console.log('weather provider ' + name + ' skipped for ' + (BREAKER_COOLDOWN_MS / 60000) + ' min');
+    }
+  }
+
+  // providers: [{ name, fetch(onOk, onErr) }]; onOk(result, name) runs at most once
+  function runProviders(providers, onOk, onFail) {
+    var now = Date.now();
+    var queue = providers.filter(function(p){ return providerHealth(p.name).openUntil <= now; });
+    var next = 0, pending = 0, done = false, hedgeTimer = null;
+    function launch() {
+      if (done || next >= queue.length) return;
+      var p = queue[next++];
+      var started = Date.now(), finished = false;
+      pending++;
+      if (hedgeTimer) clearTimeout(hedgeTimer);
+      hedgeTimer = (next < queue.length) ? setTimeout(launch, hedgeDelay(p.name)) : null;
+      p.fetch(function(result){
+        if (finished) return;
+        finished = true; pending--;
+        recordProviderResult(p.name, true, Date.now() - started);
+        if (done) return;
+        done = true;
+        if (hedgeTimer) clearTimeout(hedgeTimer);
+        onOk(result, p.name);
+      }, function(){
+        if (finished) return;
+        finished = true; pending--;
+        recordProviderResult(p.name, false);
+        if (done) return;
+        if (next < queue.length) {
+          launch();
+        } else if (pending === 0) {
+          done = true;
+          onFail();
+        }
+      });
+    }
+    if (!queue.length) { onFail(); return; }
+    launch();
+  }
+
+  // Weather fetch with caching and throttling.
+  // A reading is { temp, unit, ts (s), lat, lon, code, high, low, forecastStart (s), forecast[] };
+  // code/high/low and forecast entries may be null. It is persisted so a restart
+  // within the refresh interval needs no network at all.
+  var FORECAST_HOURS = 24;
   var _lastWeather = { ts: 0, temp: null };
-  function sendWeather(temp, unit) {
+  var savedWeather = _store.weather;
+  if (savedWeather && isNum(savedWeather.temp) && isNum(savedWeather.ts)) _lastWeather = savedWeather;
+
+  // Hourly temps as signed bytes; 0x80 (-128) marks a missing hour on the watch
+  function packForecast(list) {
+    return (list || []).slice(0, FORECAST_HOURS).map(function(t){
+      return (!isNum(t) || t < -127 || t > 127) ? 0x80 : (t & 0xFF);
+    });
+  }
+
+  function weatherDict(w, unit) {
+    var dict = {
+      'WEATHER_TEMP': w.temp,
+      'WEATHER_TIMESTAMP': w.ts,
+      'TEMP_UNIT': unit === 'F' ? 1 : 0
+    };
+    if (isNum(w.code)) dict.WEATHER_CODE = w.code;
+    if (isNum(w.high)) dict.WEATHER_HIGH = w.high;
+    if (isNum(w.low)) dict.WEATHER_LOW = w.low;
+    if (w.forecast && w.forecast.length && isNum(w.forecastStart)) {
+      dict.WEATHER_FORECAST = packForecast(w.forecast);
+      dict.WEATHER_FORECAST_START = w.forecastStart;
+    }
+    return dict;
+  }
+  function sendWeather(w, unit) {
     try {
-      Pebble.sendAppMessage(toKeyed({ 'WEATHER_TEMP': temp, 'TEMP_UNIT': unit === 'F' ? 1 : 0 }));
+      sendToWatch(weatherDict(w, unit));
     } catch(e) {}
   }
+  // Within the refresh interval the cached reading and forecast are good enough
+  function weatherCacheFresh() {
+    var unit = config.tempUnit === 'F' ? 'F' : 'C';
+    var maxAgeMs = (Math.max(5, parseInt(config.weatherIntervalMin||30,10)) - 1) * 60 * 1000;
+    var nearCached = !_location || !isNum(_lastWeather.lat) ||
+      distanceKm(_lastWeather, _location) < LOCATION_REFETCH_KM;
+    return _lastWeather.temp !== null && _lastWeather.unit === unit && nearCached &&
+      (Date.now() - _lastWeather.ts * 1000) < maxAgeMs;
+  }
   function fetchWeather() {
-    var now = Date.now();
     var unit = config.tempUnit === 'F' ? 'F' : 'C';
-    // If we have a recent value (<10 min), send it immediately to avoid '--'
-    if (_lastWeather.temp !== null && (now - _lastWeather.ts) < 10*60*1000) {
-      sendWeather(_lastWeather.temp, unit);
+    // Answer from cache and skip location and HTTP entirely while it is fresh
+    function onMoved(moved) { if (moved) fetchWeather(); }
+    if (weatherCacheFresh()) {
+      sendWeather(_lastWeather, unit);
+      refreshLocationIfOld(onMoved);
+      return;
+    }
+    function toUnit(c) {
+      var v = parseFloat(c);
+      if (!isFinite(v)) return null;
+      return Math.round(unit === 'F' ? (v * 9/5) + 32 : v);
     }
     function tryOpenMeteo(lat, lon, onOk, onErr) {
       var url = (config.weatherApi || 'https://api.open-meteo.com/v1/forecast') +
-        '?latitude=' + lat + '&longitude=' + lon + '&current_weather=true';
+        '?latitude=' + lat + '&longitude=' + lon + '&current_weather=true' +
+        '&hourly=temperature_2m&daily=temperature_2m_max,temperature_2m_min' +
+        '&forecast_days=2&timezone=auto&timeformat=unixtime';
       var req = new XMLHttpRequest();
       req.onload = function() {
         try {
           var json = JSON.parse(this.responseText || '{}');
           var cw = json.current_weather || {};
-          var t = Math.round(parseFloat(cw.temperature));
-          if (!isFinite(t)) throw new Error('no temp');
-          if (unit === 'F') t = Math.round((t * 9/5) + 32);
-          onOk(t);
+          var daily = json.daily || {};
+          var hourly = json.hourly || {};
+          var t = toUnit(cw.temperature);
+          if (t === null) throw new Error('no temp');
+          // Hourly slots starting with the one that contains "now"
+          var times = hourly.time || [], temps = hourly.temperature_2m || [];
+          var nowS = Math.floor(Date.now() / 1000);
+          var first = 0;
+          while (first + 1 < times.length && times[first + 1] <= nowS) first++;
+          var forecast = [];
+          for (var i = first; i < times.length && forecast.length < FORECAST_HOURS; i++) {
+            forecast.push(toUnit(temps[i]));
+          }
+          onOk({
+            temp: t,
+            code: parseInt(cw.weathercode, 10),
+            high: toUnit(daily.temperature_2m_max && daily.temperature_2m_max[0]),
+            low: toUnit(daily.temperature_2m_min && daily.temperature_2m_min[0]),
+            forecastStart: forecast.length ? times[first] : null,
+            forecast: forecast
+          });
         } catch(e) { onErr('parse'); }
       };
       req.onerror = function(){ onErr('network'); };
@@ -194,10 +640,11 @@ var keys = require('message_keys');
         try {
           var json = JSON.parse(this.responseText || '{}');
           var cc = (json.current_condition && json.current_condition[0]) || {};
-          var key = (unit === 'F') ? 'temp_F' : 'temp_C';
-          var t = Math.round(parseFloat(cc[key]));
-          if (!isFinite(t)) throw new Error('no temp');
-          onOk(t);
+          var day = (json.weather && json.weather[0]) || {};
+          var t = toUnit(cc.temp_C);
+          if (t === null) throw new Error('no temp');
+          // wttr.in uses its own condition codes and 3-hourly steps: no WMO code, no forecast
+          onOk({ temp: t, code: null, high: toUnit(day.maxtempC), low: toUnit(day.mintempC) });
         } catch(e) { onErr('parse'); }
       };
       req.onerror = function(){ onErr('network'); };
@@ -206,44 +653,44 @@ var keys = require('message_keys');
       req.timeout = 10000;
       req.send();
     }
-    function doFetch(lat, lon) {
-      tryOpenMeteo(lat, lon, function(t){
-        _lastWeather = { ts: Date.now(), temp: t };
-        sendWeather(t, unit);
-      }, function(){
-        // fallback
-        tryWttr(lat, lon, function(t){
-          _lastWeather = { ts: Date.now(), temp: t };
-          sendWeather(t, unit);
-        }, function(){
-          if (_lastWeather.temp !== null) sendWeather(_lastWeather.temp, unit);
-        });
+    function onWeather(w) {
+      w.ts = Math.floor(Date.now() / 1000);
+      w.unit = unit;
+      // Keep a previous forecast when the fallback provider has none; the watch does the same
+      if (!w.forecast && _lastWeather.forecast && _lastWeather.unit === unit) {
+        w.forecastStart = _lastWeather.forecastStart;
+        w.forecast = _lastWeather.forecast;
+      }
+      _lastWeather = w;
+      storeSet('weather', w);
+      sendWeather(w, unit);
+    }
+    function doFetch(loc) {
+      function onOk(w) {
+        w.lat = loc.lat;
+        w.lon = loc.lon;
+        onWeather(w);
+      }
+      runProviders([
+        { name: 'open-meteo', fetch: function(ok, err){ tryOpenMeteo(loc.lat, loc.lon, ok, err); } },
+        { name: 'wttr', fetch: function(ok, err){ tryWttr(loc.lat, loc.lon, ok, err); } }
+      ], onOk, function(){
+        if (_lastWeather.temp !== null && _lastWeather.unit === unit) sendWeather(_lastWeather, unit);
       });
     }
-    // Try geolocation; fallback to last known or a default (Berlin) if it fails
-    navigator.geolocation.getCurrentPosition(function(pos){
-      doFetch(pos.coords.latitude, pos.coords.longitude);
-    }, function(){
-      try {
-        var saved = JSON.parse(localStorage.getItem('supercgm_last_loc')||'null');
-        if (saved && saved.lat && saved.lon) {
-          doFetch(saved.lat, saved.lon);
-          return;
-        }
-      } catch(_) {}
-      // default coords (Berlin)
-      doFetch(52.5200, 13.4050);
-    }, { timeout: 8000, maximumAge: 900000 });
-  }
-  // persist last location when available
-  try {
-    navigator.geolocation.getCurrentPosition(function(pos){
-      localStorage.setItem('supercgm_last_loc', JSON.stringify({lat: pos.coords.latitude, lon: pos.coords.longitude}));
-    });
-  } catch(e){}
+    if (_location) {
+      // Last known position now; a fresher fix only matters if it moved us
+      doFetch(_location);
+      refreshLocationIfOld(onMoved);
+    } else {
+      // First run: nothing cached yet, so wait for one fix (or fall back to Berlin)
+      refreshLocation(function(){ doFetch(_location || DEFAULT_LOCATION); });
+    }
+  }
 
   var weatherTimer = null;
-  function scheduleWeather() {
+  // deferFirst: skip the immediate fetch (at launch the startup snapshot decides)
+  function scheduleWeather(deferFirst) {
     if (weatherTimer) {
       clearInterval(weatherTimer);
       weatherTimer = null;
@@ -251,90 +698,421 @@ var keys = require('message_keys');
     var ms = Math.max(5, parseInt(config.weatherIntervalMin||30,10)) * 60 * 1000;
     weatherTimer = setInterval(fetchWeather, ms);
   // trigger an immediate fetch as well (throttled by cache)
-  setTimeout(fetchWeather, 1000);
+  if (!deferFirst) setTimeout(fetchWeather, 1000);
   }
 
-  function scheduleBG() {
-    // Fetch immediately, then every 5 minutes if BG is configured in any row and URL exists
-    var anyBG = config.rows && config.rows.some(function(r){return r.type === 5;});
-    if (anyBG && config.bgUrl) {
-      fetchBG();
-      if (typeof scheduleBG._timer !== 'undefined' && scheduleBG._timer) clearInterval(scheduleBG._timer);
-      var mins = Math.max(1, parseInt(config.bgFetchIntervalMin || 5, 10));
-      scheduleBG._timer = setInterval(fetchBG, mins * 60 * 1000);
+  // Rows showing the wearer's own site: the BG row and the extras rows (delta, IOB, COB, raw)
+  var EXTRAS_ROW_TYPES = [12, 13, 14, 15];
+  function hasBGRow() {
+    return !!(config.rows && config.rows.some(function(r){return r.type === 5 || EXTRAS_ROW_TYPES.indexOf(r.type) >= 0;}));
+  }
+
+  function extrasShown() {
+    return !!(config.rows && config.rows.some(function(r){ return EXTRAS_ROW_TYPES.indexOf(r.type) >= 0; }));
+  }
+
+  // Follower mode: indexes into config.followers that have a URL and a row showing them
+  // (row type 10 = follower 0, 11 = follower 1)
+  var FOLLOWER_ROW_TYPE = 10, MAX_FOLLOWERS = 2;
+  function activeFollowers() {
+    var out = [];
+    for (var i = 0; i < MAX_FOLLOWERS; i++) {
+      var f = config.followers && config.followers[i];
+      var shown = config.rows && config.rows.some(function(r){ return r.type === FOLLOWER_ROW_TYPE + i; });
+      if (f && f.url && shown) out.push(i);
+    }
+    return out;
+  }
+
+  function followerTag(i) {
+    var f = config.followers && config.followers[i];
+    var tag = String((f && f.tag) || '').toUpperCase().replace(/[^A-Z0-9]/g, '');
+    return tag.charAt(0) || 'BC'.charAt(i);
+  }
+
+  function bgPollNeeded() {
+    return (hasBGRow() && !!config.bgUrl) || activeFollowers().length > 0;
+  }
+
+  function scheduleBG(deferFirst) {
+    // Fetch immediately, then on the poll plan if BG is configured in any row and URL exists.
+    // While the live stream is up, polling only runs as a sparse safety net (followers,
+    // which have no stream, keep the normal plan).
+    if (bgPollNeeded()) {
+      if ((!_stream.connected || activeFollowers().length) && !deferFirst) fetchBG();
+      armBGPoll();
     } else {
-      if (scheduleBG._timer) { clearInterval(scheduleBG._timer); scheduleBG._timer = null; }
+      if (_bgPoll.timer) { clearTimeout(_bgPoll.timer); _bgPoll.timer = null; }
+    }
+  }
+
+  // Adaptive polling: fast when glucose moves quickly or is near/heading past a threshold,
+  // slow when it is flat well inside the range. The rate is mg/dL per 5 min from the last
+  // two readings, or estimated from the trend arrow when there is no usable pair.
+  var RATE_BY_TREND = {};
+  RATE_BY_TREND[BG_TREND.DOUBLE_UP] = 15; RATE_BY_TREND[BG_TREND.SINGLE_UP] = 10;
+  RATE_BY_TREND[BG_TREND.FORTY_FIVE_UP] = 5; RATE_BY_TREND[BG_TREND.FLAT] = 0;
+  RATE_BY_TREND[BG_TREND.FORTY_FIVE_DOWN] = -5; RATE_BY_TREND[BG_TREND.SINGLE_DOWN] = -10;
+  RATE_BY_TREND[BG_TREND.DOUBLE_DOWN] = -15;
+  var BG_LOOKAHEAD_MIN = 15;
+  var _bgHistory = (_store.bgHistory || []).filter(function(r){ return r && isNum(r.sgv) && isNum(r.ts); }); // [{ sgv, ts }], newest last
+  var _bgPoll = { timer: null, min: null, reason: '' };
+
+  function bgRatePer5() {
+    var n = _bgHistory.length;
+    if (n >= 2) {
+      var a = _bgHistory[n-2], b = _bgHistory[n-1], dt = b.ts - a.ts;
+      if (dt >= 120 && dt <= 900) return (b.sgv - a.sgv) * 300 / dt;
+    }
+    if (_lastBG && _lastBG.trend in RATE_BY_TREND) return RATE_BY_TREND[_lastBG.trend];
+    return 0;
+  }
+
+  // { min, reason } for the next poll
+  function bgPollPlan() {
+    var fixed = Math.max(1, parseInt(config.bgFetchIntervalMin || 5, 10));
+    if (!config.bgAdaptive) return { min: fixed, reason: 'fixed' };
+    var lo = Math.max(1, parseInt(config.bgPollMinMin || 1, 10));
+    var hi = Math.max(lo, parseInt(config.bgPollMaxMin || 10, 10));
+    var mid = Math.round((lo + hi) / 2);
+    if (!_lastBG || Date.now() / 1000 - _lastBG.ts > 15 * 60) {
+      return { min: Math.min(hi, Math.max(lo, fixed)), reason: 'no recent reading' };
     }
+    var sgv = _lastBG.sgv, rate = bgRatePer5();
+    var projected = sgv + rate * BG_LOOKAHEAD_MIN / 5;
+    var margin = Math.min(sgv - config.low, config.high - sgv);
+    if (sgv <= config.low || projected <= config.low) return { min: lo, reason: 'low or heading low' };
+    if (Math.abs(rate) >= 10) return { min: lo, reason: 'changing fast' };
+    if (sgv >= config.high || projected >= config.high) return { min: mid, reason: 'high or heading high' };
+    if (Math.abs(rate) >= 5) return { min: mid, reason: 'changing' };
+    if (margin < 20) return { min: mid, reason: 'near threshold' };
+    return { min: hi, reason: 'stable' };
   }
 
+  // delayMs: first poll after this instead of the full interval (resuming after a restart)
+  function armBGPoll(delayMs) {
+    if (_bgPoll.timer) { clearTimeout(_bgPoll.timer); _bgPoll.timer = null; }
+    if (!bgPollNeeded()) return;
+    var plan = bgPollPlan();
+    if (_stream.connected && !activeFollowers().length && plan.min < STREAM_SAFETY_POLL_MIN) {
+      plan = { min: STREAM_SAFETY_POLL_MIN, reason: 'stream up' };
+    }
+    if (plan.min !== _bgPoll.min || plan.reason !== _bgPoll.reason) {
+      console.log('BG poll every ' + plan.min + ' min (' + plan.reason + ')');
+    }
+    _bgPoll.min = plan.min;
+    _bgPoll.reason = plan.reason;
+    _bgPoll.timer = setTimeout(function(){
+      _bgPoll.timer = null;
+      fetchBG();
+      armBGPoll();
+    }, isNum(delayMs) ? delayMs : plan.min * 60 * 1000);
+  }
+
+  // At startup: poll only if the last poll, possibly made by a previous PebbleKit JS
+  // instance, is older than the current plan; otherwise continue its schedule
+  function resumeBGPoll() {
+    if (!bgPollNeeded()) return;
+    var polledAt = _store.bgPolledAt || (_lastBG ? _lastBG.ts * 1000 : 0); // migrated state has no poll time
+    var dueMs = bgPollPlan().min * 60 * 1000 - (Date.now() - polledAt);
+    if (dueMs <= 0 && (!_stream.connected || activeFollowers().length)) fetchBG();
+    else armBGPoll(Math.max(0, dueMs));
+  }
+
+  // Last reading forwarded to the watch, kept for the startup snapshot
+  var _lastBG = _store.lastBG;
+  if (_lastBG && (!isNum(_lastBG.sgv) || !isNum(_lastBG.ts))) _lastBG = null;
+  if (_lastBG && !_bgHistory.length) _bgHistory.push({ sgv: _lastBG.sgv, ts: _lastBG.ts });
+
+  function bgDict(r) {
+    var dict = {
+      'BG_STATUS': BG_STATUS.OK,
+      'BG_SGV': r.sgv,
+      'BG_TIMESTAMP': r.ts,
+      'BG_TREND': r.trend,
+      'BG_UNIT': (config.bgUnit === 'mmol' ? 1 : 0)
+    };
+    if (r.extras && extrasShown()) dict.BG_EXTRAS = packExtras(r.extras);
+    return dict;
+  }
+
+  // BG_EXTRAS: delta (mg/dL), IOB (0.1 U), COB (g), raw (mg/dL) as int16 LE; 0x8000 = none
+  function packExtras(e) {
+    var out = [];
+    [e.delta, isNum(e.iob) ? e.iob * 10 : null, e.cob, e.raw].forEach(function(v){
+      var n = isNum(v) ? Math.max(-32767, Math.min(32767, Math.round(v))) : -32768;
+      out.push(n & 0xFF, (n >> 8) & 0xFF);
+    });
+    return out;
+  }
+
+  // Readings at or heading below urgent low skip the outbox queue (see sendToWatch)
+  function bgIsUrgent() {
+    var urgentLow = isNum(config.bgUrgentLow) ? config.bgUrgentLow : 55;
+    if (!_lastBG || urgentLow <= 0) return false;
+    return _lastBG.sgv < urgentLow || _lastBG.sgv + bgRatePer5() * BG_LOOKAHEAD_MIN / 5 < urgentLow;
+  }
+
+  // ts in seconds; extras as parsed by readExtras(), absent for streamed readings
+  function noteBGReading(sgv, ts, trend, extras) {
+    _stream.lastTs = Math.max(_stream.lastTs, ts);
+    _lastBG = { sgv: sgv, ts: ts, trend: trend };
+    if (extras) _lastBG.extras = extras;
+    if (!_bgHistory.length || ts > _bgHistory[_bgHistory.length - 1].ts) {
+      _bgHistory.push({ sgv: sgv, ts: ts });
+      if (_bgHistory.length > 3) _bgHistory.shift();
+    }
+    storeSet('lastBG', _lastBG);
+    storeSet('bgHistory', _bgHistory);
+  }
+
+  // Streamed readings carry no /pebble extras; delta is derived from the previous reading
+  // so the delta row stays right, the other extras rows show "--" until the next poll
+  var STREAM_DELTA_MAX_GAP_S = 15 * 60;
+  function sendBGReading(sgv, ts, trend) {
+    var prev = _bgHistory[_bgHistory.length - 1], extras = null;
+    if (prev && ts > prev.ts && ts - prev.ts <= STREAM_DELTA_MAX_GAP_S) {
+      extras = { delta: sgv - prev.sgv, iob: null, cob: null, raw: null };
+    }
+    noteBGReading(sgv, ts, trend, extras);
+    sendToWatch(bgDict(_lastBG), null, null, bgIsUrgent());
+    // A new reading can change the plan; the next poll counts from now
+    if (config.bgAdaptive) armBGPoll();
+  }
+
+  // BG_FOLLOW record: follower slot, status, trend, sgv (int16 LE), timestamp (int32 LE)
+  function packFollower(i, r) {
+    var sgv = r.status === BG_STATUS.OK ? r.sgv : -1, ts = r.ts || 0;
+    return [i, r.status, r.trend || 0, sgv & 0xFF, (sgv >> 8) & 0xFF,
+      ts & 0xFF, (ts >>> 8) & 0xFF, (ts >>> 16) & 0xFF, (ts >>> 24) & 0xFF];
+  }
+
+
+  // Optional push mode: keep Nightscout's socket.io websocket (Engine.IO v4 framing) open
+  // and forward each new reading the moment the server announces it. Reconnects with
+  // exponential backoff; while it is down, scheduleBG() polls at the normal interval.
+  // Nightscout only sends dataUpdate to sockets that passed `authorize`, so the stream
+  // counts as up once the server acks read access (or the first dataUpdate arrives); a
+  // missing ack closes the socket and retries, a denied one stops streaming until the
+  // config changes. Polling stays at its normal interval in both cases.
+  var STREAM_BACKOFF_MIN_MS = 2000, STREAM_BACKOFF_MAX_MS = 5 * 60 * 1000;
+  var STREAM_SAFETY_POLL_MIN = 15;
+  var STREAM_AUTH_TIMEOUT_MS = 10000;
+  // lastTs starts at the stored reading, so a restarted companion does not resend it without its extras
+  var _stream = { ws: null, connected: false, denied: false, backoff: STREAM_BACKOFF_MIN_MS, retryTimer: null,
+    authTimer: null, lastTs: _lastBG ? _lastBG.ts : 0 };
+
+  function stopStream() {
+    if (_stream.retryTimer) { clearTimeout(_stream.retryTimer); _stream.retryTimer = null; }
+    if (_stream.authTimer) { clearTimeout(_stream.authTimer); _stream.authTimer = null; }
+    var ws = _stream.ws;
+    _stream.ws = null;
+    if (ws) { try { ws.close(); } catch(e) {} }
+    if (_stream.connected) {
+      _stream.connected = false;
+      scheduleBG();
+    }
+  }
+
+  function startStream() {
+    stopStream();
+    _stream.denied = false;
+    _stream.backoff = STREAM_BACKOFF_MIN_MS;
+    connectStream();
+  }
+
+  function connectStream() {
+    if (!config.bgStreaming || !config.bgUrl || !hasBGRow() || _stream.denied || typeof WebSocket === 'undefined') return;
+    var base = config.bgUrl.replace(/\/$/, '');
+    var token = (base.match(/[?&]token=([^&]+)/) || [])[1];
+    var url = base.replace(/\?.*$/, '').replace(/\/$/, '').replace(/^http/, 'ws') + '/socket.io/?EIO=4&transport=websocket';
+    var ws;
+    try { ws = new WebSocket(url); } catch(e) { retryStream(); return; }
+    _stream.ws = ws;
+    function authorized() {
+      if (_stream.authTimer) { clearTimeout(_stream.authTimer); _stream.authTimer = null; }
+      if (_stream.connected) return;
+      _stream.connected = true;
+      _stream.backoff = STREAM_BACKOFF_MIN_MS;
+      scheduleBG();
+    }
+    function drop(denied) {
+      _stream.denied = denied;
+      try { ws.close(); } catch(e) {}
+      ws.onclose();
+    }
+    ws.onmessage = function(ev) {
+      var msg = String(ev.data);
+      if (msg.charAt(0) === '0') { ws.send('40'); return; }   // Engine.IO open -> join namespace "/"
+      if (msg === '2') { ws.send('3'); return; }               // ping -> pong
+      if (msg.indexOf('40') === 0) {                           // namespace joined: authorize with ack id 0
+        ws.send('420' + JSON.stringify(['authorize', { client: 'pebble', token: token ? decodeURIComponent(token) : undefined, history: 1 }]));
+        _stream.authTimer = setTimeout(function(){ _stream.authTimer = null; drop(false); }, STREAM_AUTH_TIMEOUT_MS);
+        return;
+      }
+      if (msg.indexOf('430') === 0) {                          // authorize ack: [{ read, write, ... }]
+        var ack = null;
+        try { ack = JSON.parse(msg.slice(3))[0]; } catch(e) {}
+        if (ack && ack.read) authorized();
+        else drop(true);
+        return;
+      }
+      if (msg.indexOf('42') === 0) {
+        try {
+          var packet = JSON.parse(msg.slice(2));
+          if (packet[0] === 'dataUpdate') {
+            authorized();
+            onStreamData(packet[1]);
+          }
+        } catch(e) {}
+      }
+    };
+    ws.onclose = ws.onerror = function() {
+      if (_stream.ws !== ws) return;
+      _stream.ws = null;
+      if (_stream.authTimer) { clearTimeout(_stream.authTimer); _stream.authTimer = null; }
+      if (_stream.connected) {
+        _stream.connected = false;
+        scheduleBG();
+      }
+      if (!_stream.denied) retryStream();
+    };
+  }
+
+  function retryStream() {
+    if (_stream.retryTimer) return;
+    var delay = _stream.backoff * (0.75 + Math.random() * 0.5);
+    _stream.backoff = Math.min(_stream.backoff * 2, STREAM_BACKOFF_MAX_MS);
+    _stream.retryTimer = setTimeout(function(){
+      _stream.retryTimer = null;
+      connectStream();
+    }, delay);
+  }
+
+  // dataUpdate carries the latest sgvs as { mgdl, mills, direction }; forward only newer ones
+  function onStreamData(data) {
+    var sgvs = (data && data.sgvs) || [];
+    var latest = null;
+    sgvs.forEach(function(e){ if (e && isNum(e.mills) && (!latest || e.mills > latest.mills)) latest = e; });
+    if (!latest || !isNum(latest.mgdl)) return;
+    var ts = Math.floor(latest.mills / 1000);
+    if (ts <= _stream.lastTs) return;
+    sendBGReading(latest.mgdl, ts, trendFromReading(latest.direction, latest.trend));
+  }
+
+  // One poll cycle: every configured site is fetched concurrently and all results go to
+  // the watch in a single message. The wearer's own site uses the BG_* keys, followers
+  // are packed into BG_FOLLOW. Requests share the phone's HTTP stack, which keeps
+  // connections to the same host alive between cycles.
   function fetchBG() {
-    function sendStatus(status, dict) {
-      var payload = dict || {};
-      payload.BG_STATUS = status;
-      Pebble.sendAppMessage(toKeyed(payload));
+    var sites = [];
+    if (hasBGRow() || !activeFollowers().length) sites.push({ follower: -1, url: config.bgUrl });
+    activeFollowers().forEach(function(i){ sites.push({ follower: i, url: config.followers[i].url }); });
+    var pending = sites.length, results = [];
+    sites.forEach(function(site, n){
+      fetchSite(site.url, function(r){
+        results[n] = r;
+        if (--pending === 0) deliverBG(sites, results);
+      });
+    });
+  }
+
+  function deliverBG(sites, results) {
+    var dict = {}, urgent = false, fresh = false, packed = [];
+    sites.forEach(function(site, n){
+      var r = results[n];
+      if (site.follower >= 0) {
+        packed = packed.concat(packFollower(site.follower, r));
+        if (r.status === BG_STATUS.OK || !_store.followers[site.follower]) _store.followers[site.follower] = r;
+      } else if (r.status === BG_STATUS.OK) {
+        noteBGReading(r.sgv, r.ts, r.trend, r.extras);
+        var b = bgDict(_lastBG);
+        Object.keys(b).forEach(function(k){ dict[k] = b[k]; });
+        urgent = bgIsUrgent();
+        fresh = true;
+      } else {
+        dict.BG_STATUS = r.status;
+      }
+    });
+    if (packed.length) dict.BG_FOLLOW = packed;
+    storeSet('bgPolledAt', Date.now());
+    sendToWatch(dict, null, null, urgent);
+    if (fresh && config.bgAdaptive) armBGPoll();
+  }
+
+  // Extras the /pebble endpoint adds to a reading when the site has them enabled: bgdelta
+  // (mg/dL with units=mg), iob (U), cob (g) and, with rawbg, unfiltered/filtered plus a
+  // calibration that turns them into mg/dL (Nightscout's rawbg formula)
+  function readExtras(b, cal) {
+    function num(v) { var n = parseFloat(v); return isFinite(n) ? n : null; }
+    var e = { delta: num(b.bgdelta), iob: num(b.iob), cob: num(b.cob), raw: null };
+    var sgv = num(b.sgv), unfiltered = num(b.unfiltered), filtered = num(b.filtered);
+    var slope = cal && num(cal.slope), scale = cal && num(cal.scale), intercept = cal && num(cal.intercept);
+    if (slope && isNum(scale) && isNum(intercept) && unfiltered) {
+      var raw = scale * (unfiltered - intercept) / slope;
+      if (filtered && sgv >= 40) raw = raw * sgv / (scale * (filtered - intercept) / slope);
+      if (isFinite(raw)) e.raw = Math.round(raw);
+    }
+    return e;
+  }
+
+  // done({ status, sgv, ts, trend, extras }) with ts in seconds
+  function fetchSite(baseUrl, onResult) {
+    var answered = false;
+    function done(r) {
+      if (!answered) { answered = true; onResult(r); }
     }
-    if (!config.bgUrl) {
-      sendStatus(BG_STATUS.NO_DATA);
+    if (!baseUrl) {
+      done({ status: BG_STATUS.NO_DATA });
       return;
     }
-    var url = config.bgUrl.replace(/\/$/, '') + '/pebble';
+    // units=mg keeps sgv and bgdelta in mg/dL whatever the site displays; a ?token= on the
+    // configured URL moves behind the path
+    var q = baseUrl.indexOf('?');
+    var url = (q >= 0 ? baseUrl.slice(0, q) : baseUrl).replace(/\/$/, '') + '/pebble?units=mg' +
+      (q >= 0 ? '&' + baseUrl.slice(q + 1) : '');
     var req = new XMLHttpRequest();
     req.onload = function() {
       try {
         if (this.status && (this.status < 200 || this.status >= 300)) {
-          sendStatus(BG_STATUS.NO_CONN);
+          done({ status: BG_STATUS.NO_CONN });
           return;
         }
         var json = JSON.parse(this.responseText);
         // responses can vary; handle Nightscout /pebble (json.bgs[0]) and others
-        var sgv = null, ts = null, trend = null;
+        var sgv = null, ts = null, trend = BG_TREND.NONE, extras = null;
         if (json && Array.isArray(json.bgs) && json.bgs.length > 0) {
           var b = json.bgs[0];
           sgv = parseInt(b.sgv || b.glucose || b.value, 10);
           ts = parseInt((b.datetime || b.date || b.mills || b.timestamp || 0), 10);
-          trend = b.direction || b.trend || null;
+          trend = trendFromReading(b.direction, b.trend);
+          extras = readExtras(b, json.cals && json.cals[0]);
         } else if (Array.isArray(json) && json.length > 0) {
           sgv = parseInt(json[0].sgv || json[0].glucose || json[0].value, 10);
           ts = parseInt((json[0].datetime || json[0].date || json[0].mills || json[0].timestamp || 0), 10);
-          trend = json[0].direction || json[0].trend || null;
+          trend = trendFromReading(json[0].direction, json[0].trend);
         } else if (json && (json.sgv || json.value || json.glucose)) {
           sgv = parseInt(json.sgv || json.value || json.glucose, 10);
           ts = parseInt(json.datetime || json.date || json.mills || json.timestamp || 0, 10);
-          trend = json.direction || json.trend || null;
+          trend = trendFromReading(json.direction, json.trend);
         }
         if (ts && ts > 1000000000000) { // ms -> s
           ts = Math.floor(ts / 1000);
         }
         if (isFinite(sgv)) {
-          // Map trend to a compact arrow string for watch to display
-          var arrow = '';
-          var dir = (trend||'').toLowerCase();
-          if (dir.indexOf('doubleup')>=0) arrow='↑↑';
-          else if (dir.indexOf('singleup')>=0 || dir==='up') arrow='↑';
-          else if (dir.indexOf('fortyfiveup')>=0) arrow='↗';
-          else if (dir.indexOf('flat')>=0) arrow='→';
-          else if (dir.indexOf('fortyfivedown')>=0) arrow='↘';
-          else if (dir.indexOf('singledown')>=0 || dir==='down') arrow='↓';
-          else if (dir.indexOf('doubledown')>=0) arrow='↓↓';
-
-          sendStatus(BG_STATUS.OK, {
-            'BG_SGV': sgv,
-            'BG_TIMESTAMP': ts || Math.floor(Date.now()/1000),
-            'BG_TREND': arrow,
-            'BG_UNIT': (config.bgUnit === 'mmol' ? 1 : 0)
-          });
+          done({ status: BG_STATUS.OK, sgv: sgv, ts: ts || Math.floor(Date.now()/1000), trend: trend, extras: extras });
         } else {
-          sendStatus(BG_STATUS.NO_DATA);
+          done({ status: BG_STATUS.NO_DATA });
         }
       } catch(e) {
-        sendStatus(BG_STATUS.NO_DATA);
+        done({ status: BG_STATUS.NO_DATA });
       }
     };
     req.onerror = function() {
-      sendStatus(BG_STATUS.NO_CONN);
+      done({ status: BG_STATUS.NO_CONN });
     };
     req.ontimeout = function() {
-      sendStatus(BG_STATUS.NO_CONN);
+      done({ status: BG_STATUS.NO_CONN });
     };
     req.open('GET', url);
     req.timeout = 10000;
@@ -343,14 +1121,13 @@ var keys = require('message_keys');
 
   function loadSavedConfig() {
     try {
-      var saved = localStorage.getItem('supercgm_config');
-      if (saved) {
-        var cfg = JSON.parse(saved);
-        if (cfg && cfg.rows) {
+      var cfg = _store.config;
+      if (cfg) {
+        if (cfg.rows) {
           cfg.rows = normalizeRows(cfg.rows);
         }
         // Basic sanity: ensure rows exist
-        if (cfg && Array.isArray(cfg.rows)) {
+        if (Array.isArray(cfg.rows)) {
           if (!cfg.colors) cfg.colors = {};
           var g = (cfg.colors.ghost || '').toLowerCase();
           if (!g || /^#0{0,6}$/.test(g) || g === '#2a2a2a' || g === '#1e1e1e') {
@@ -372,9 +1149,12 @@ var keys = require('message_keys');
     // Load saved config if available so we don't overwrite watch with defaults
     loadSavedConfig();
     enforceBWPalette();
-    sendConfig();
-    scheduleWeather();
-    scheduleBG();
+    // The watch opens with a HELLO; answer that instead of pushing everything at once
+    scheduleWeather(true);
+    scheduleBG(true);
+    startStream();
+    _helloTimer = setTimeout(legacyStartup, HELLO_WAIT_MS);
+    sendToWatch({ 'HELLO': 1 }, function(){}, function(){});
   });
 
   Pebble.addEventListener('appmessage', function(e) {
@@ -386,6 +1166,11 @@ var keys = require('message_keys');
   console.log('REQUEST_BG received');
   fetchBG();
     }
+    if (e.payload && e.payload.HELLO) {
+      onHello(e.payload);
+    } else if (e.payload && isNum(e.payload.CONFIG_HASH)) {
+      onWatchConfigHash(e.payload.CONFIG_HASH);
+    }
   });
 
   Pebble.addEventListener('showConfiguration', function() {
@@ -398,7 +1183,8 @@ var keys = require('message_keys');
       '?platform=' + encodeURIComponent(platform) +
       '&bw=' + (isBW ? '1' : '0') +
       '&rows=' + rows +
-      '&pebble2=' + ((platform === 'diorite') ? '1' : '0');
+      '&pebble2=' + ((platform === 'diorite') ? '1' : '0') +
+      (_bgPoll.min ? '&bgPoll=' + encodeURIComponent(_bgPoll.min + ' min (' + _bgPoll.reason + ')') : '');
     Pebble.openURL(url);
   });
 
@@ -408,10 +1194,11 @@ var keys = require('message_keys');
       config = JSON.parse(decodeURIComponent(e.response));
       config.rows = normalizeRows(config.rows);
       // Persist to pkjs storage so it survives app restarts
-      try { localStorage.setItem('supercgm_config', JSON.stringify(config)); } catch(_e) {}
-      sendConfig();
+      storeSet('config', config, true);
+      sendConfig(_synced);
       scheduleWeather();
       scheduleBG();
+      startStream();
     } catch(err) {
       console.log('config parse error', err);
     }
@@ -14,7 +14,15 @@ typedef enum {
   ROW_TYPE_BATTERY = 4,
   ROW_TYPE_BG = 5,
   ROW_TYPE_STEPS = 6,
-  ROW_TYPE_HEART_RATE = 7
+  ROW_TYPE_HEART_RATE = 7,
+  ROW_TYPE_SECONDS = 8,
+  ROW_TYPE_MIN_SEC = 9,
+  ROW_TYPE_BG_PERSON2 = 10, // followed people: tag letter + value, see s_bg_follow
+  ROW_TYPE_BG_PERSON3 = 11,
+  ROW_TYPE_BG_DELTA = 12, // extras of the wearer's reading: tag letter + value, see s_bg_extras
+  ROW_TYPE_IOB = 13,
+  ROW_TYPE_COB = 14,
+  ROW_TYPE_BG_RAW = 15
 } RowType;
 
 typedef enum {
@@ -23,10 +31,25 @@ typedef enum {
   BG_STATUS_CONN_ERROR = 2
 } BgStatus;
 
+// Same numbering as Nightscout's numeric `trend` field; sent as an int by the phone
+typedef enum {
+  BG_TREND_NONE = 0,
+  BG_TREND_DOUBLE_UP = 1,
+  BG_TREND_SINGLE_UP = 2,
+  BG_TREND_FORTY_FIVE_UP = 3,
+  BG_TREND_FLAT = 4,
+  BG_TREND_FORTY_FIVE_DOWN = 5,
+  BG_TREND_SINGLE_DOWN = 6,
+  BG_TREND_DOUBLE_DOWN = 7,
+  BG_TREND_NOT_COMPUTABLE = 8,
+  BG_TREND_RATE_OUT_OF_RANGE = 9,
+  BG_TREND_COUNT
+} BgTrend;
+
 static Window *s_main_window;
 static TextLayer *s_digit_layers[ROWS][5];
 static TextLayer *s_ghost_layers[ROWS][5];
-static Layer *s_ghost_hatch_layers[ROWS][5];
+static Layer *s_ghost_hatch_layer;
 static Layer *s_bg_trend_layer;
 static GColor s_bg_trend_color;
 static Layer *s_weather_deg_layer;
@@ -34,15 +57,14 @@ static GColor s_weather_deg_color;
 static char s_weather_unit_char = 0; // 'C' or 'F'
 // Persistent 1-char + NUL buffers for each foreground slot
 static char s_slot_text[ROWS][5][2];
+static GColor s_slot_color[ROWS][5];
+static bool s_slots_styled = false; // fonts set on every slot; later draws only touch changed slots
 static GFont s_font_dseg_30;       // Bold (foreground)
 static GFont s_font_dseg_30_reg;   // Regular (ghost)
-static GFont s_font_dseg_26;       // Bold smaller (round)
-static GFont s_font_dseg_26_reg;   // Regular smaller (round)
 static GFont s_font_dseg_25;       // Bold even smaller (round fine-tune)
 static GFont s_font_dseg_25_reg;   // Regular even smaller (round fine-tune)
 static GFont s_font_dseg_29;       // Bold slightly smaller than 30 for round middle rows
 static GFont s_font_dseg_29_reg;   // Regular slightly smaller than 30 for round middle rows
-static GFont s_font_system_30;
 static GColor s_row_colors[ROWS];
 static GColor s_ghost_color;
 static RowType s_row_types[ROWS];
@@ -50,8 +72,8 @@ static bool s_show_leading_zero = true;
 static int s_date_format = 0; // 0: dd/mm, 1: mm/dd
 static int s_weekday_lang = 0; // 0: de, 1: en
 static int s_temp_unit_f = 0; // 0=C, 1=F
-static char s_weather_buf[12];
-static char s_bg_trend[8];
+static int s_weather_interval_min = 30; // phone fetch interval; drives weather staleness
+static BgTrend s_bg_trend = BG_TREND_NONE;
 static int s_bg_unit_mmol = 0; // 0 mg/dL, 1 mmol
 
 static int s_bg_sgv = -1; // -1 unknown
@@ -60,11 +82,106 @@ static time_t s_bg_timestamp = 0;
 static int s_bg_timeout_min = 20;
 static int s_bg_low = 80;
 static int s_bg_high = 180;
+static int s_bg_urgent_low = 55; // mg/dL; 0 disables the urgent-low alert
+static int s_bg_alert_snooze_min = 30; // repeat interval while still urgent-low
+
+// Follower mode: people followed besides the wearer's own site (which is the s_bg_*
+// state above). Their readings arrive packed in BG_FOLLOW, one record per person.
+#define BG_MAX_PERSONS 3
+#define BG_FOLLOW_RECORD_SIZE 9 // slot, status, trend, sgv (int16 LE), timestamp (int32 LE)
+typedef struct {
+  int sgv; // -1 unknown
+  BgStatus status;
+  BgTrend trend;
+  time_t timestamp;
+} BgPerson;
+static BgPerson s_bg_follow[BG_MAX_PERSONS - 1];
+static char s_bg_follow_tags[BG_MAX_PERSONS] = "BC"; // 1-letter tag per followed person
+
+// Extras Nightscout's /pebble endpoint returns with the wearer's reading; they arrive in
+// the same message as BG_EXTRAS (four int16 LE, BG_EXTRA_UNKNOWN when the site has none)
+#define BG_EXTRA_UNKNOWN INT16_MIN
+#define BG_EXTRAS_SIZE 8
+typedef struct {
+  int16_t delta; // mg/dL since the previous reading
+  int16_t iob10; // insulin on board, 0.1 U
+  int16_t cob;   // carbs on board, g
+  int16_t raw;   // raw sensor BG, mg/dL
+  time_t timestamp; // of the reading they came with
+} BgExtras;
+static BgExtras s_bg_extras = { BG_EXTRA_UNKNOWN, BG_EXTRA_UNKNOWN, BG_EXTRA_UNKNOWN, BG_EXTRA_UNKNOWN, 0 };
+
+// Persisted last reading so the BG row (and HELLO's BG_TIMESTAMP) is right from the first
+// frame; written only when a message changes it
+#define PERSIST_BG_KEY 1004
+typedef struct {
+  int version; // bump when fields change
+  int sgv;
+  BgStatus status;
+  BgTrend trend;
+  time_t timestamp;
+  int unit_mmol;
+  BgExtras extras;
+} BgCache;
+static BgCache s_saved_bg; // last persisted copy, to skip redundant flash writes
 static GColor s_col_low, s_col_high, s_col_in;
 static uint32_t s_row_color_hex[ROWS];
 static uint32_t s_col_low_hex, s_col_high_hex, s_col_in_hex, s_ghost_hex;
 static int s_hr_bpm = -1;
 static time_t s_hr_timestamp = 0;
+static TimeUnits s_tick_units = 0; // currently subscribed tick granularity
+
+// Wrist-aware idle mode (config IDLE_MODE, off by default): after a while without a wrist
+// flick (sooner during Quiet Time) steps, heart rate, seconds rows and the degree dot are
+// blanked, the tick drops to minutes and the watch stops asking the phone for weather.
+// A flick restores the full face.
+#define IDLE_AFTER_MIN 5
+#define IDLE_AFTER_MIN_QUIET 1
+static bool s_idle_enabled = false;
+static bool s_idle = false;
+static time_t s_last_flick = 0;
+
+// Latest weather as sent numerically by the phone; formatted into slots on draw.
+// The hourly forecast lets the row advance on the hour without asking the phone.
+#define WEATHER_UNKNOWN INT16_MIN
+#define WEATHER_FORECAST_HOURS 24
+#define WEATHER_FORECAST_MISSING INT8_MIN
+#define WEATHER_REQUEST_GAP_S 600 // min spacing of watch-initiated weather requests
+typedef struct {
+  int16_t temp;       // in `unit`
+  char unit;          // 'C' or 'F'; 0 = no reading yet
+  time_t timestamp;   // when the phone fetched it
+  int16_t code;       // WMO weather condition code, WEATHER_UNKNOWN if not sent
+  int16_t high;       // today's high/low, WEATHER_UNKNOWN if not sent
+  int16_t low;
+  time_t forecast_start; // start of the hour forecast[0] applies to
+  uint8_t forecast_count;
+  int8_t forecast[WEATHER_FORECAST_HOURS]; // hourly temps in `unit`
+} WeatherData;
+static WeatherData s_weather = { .code = WEATHER_UNKNOWN, .high = WEATHER_UNKNOWN, .low = WEATHER_UNKNOWN };
+static time_t s_weather_requested_at = 0;
+
+// Persisted weather cache so the row is correct right after launch, even offline
+#define PERSIST_WEATHER_KEY 1002
+typedef struct {
+  int version; // bump when WeatherData changes
+  WeatherData data;
+} WeatherCache;
+
+// Startup handshake: one HELLO with the config hash and the timestamps of the cached
+// weather and BG; the phone answers with a single snapshot of whatever is missing or
+// stale. If the phone side is not up yet at launch, it pings with its own HELLO once it is;
+// a ping that crosses our HELLO in flight is ignored, the phone answers that one.
+static bool s_hello_pending = true;
+static bool s_hello_in_flight = false;
+
+// Phone connection: while the phone app is unreachable nothing is sent, the BG row shows
+// NO-BT once its reading is stale, and the reconnect sends one HELLO, whose snapshot
+// covers whatever went stale meanwhile (it replaces the launch HELLO when started offline)
+static bool s_connected = true;
+static time_t s_disconnected_at = 0;   // start of the current outage
+static uint32_t s_disconnected_total_s = 0; // summed over completed outages since launch
+static uint16_t s_outages = 0;
 
 static GColor ColorFromHex(uint32_t hex) {
 #if defined(PBL_COLOR)
@@ -92,7 +209,9 @@ static GColor ColorFromHex(uint32_t hex) {
 
 static void update_time(void);
 static void request_weather(void);
+static void send_hello(void);
 static void draw_all_rows(void);
+static void app_connection_handler(bool connected);
 static void trend_update_proc(Layer *layer, GContext *ctx);
 static void weather_deg_update_proc(Layer *layer, GContext *ctx);
 static void update_heart_rate(void);
@@ -100,12 +219,111 @@ static GRect get_layout_bounds(void);
 static void main_window_appear(Window *window);
 static void app_focus_handler(bool in_focus);
 static void force_redraw_layers(void);
+static void tick_handler(struct tm *tick_time, TimeUnits units_changed);
 
 #if PBL_API_EXISTS(unobstructed_area_service_subscribe)
 static void unobstructed_change(AnimationProgress progress, void *context);
 static void unobstructed_did_change(void *context);
 #endif
 
+// Everything not needed for the first frame runs from s_deferred_timer
+#define STARTUP_DEFER_MS 100
+static AppTimer *s_deferred_timer;
+
+// Timing log (build with SUPERCGM_PROFILE=1): ms since launch after each init phase, the
+// time spent in draw_all_rows() and per-frame render time, measured between a probe layer
+// drawn first and one drawn last. One line each, prefixed for grepping `pebble logs`.
+#if defined(PROFILE_TIMINGS)
+static time_t s_launch_s;
+static uint16_t s_launch_ms;
+static int32_t s_frame_start_ms;
+static uint32_t s_frame_count;
+// 1 Hz path: second ticks, ms in update_seconds_rows() and ms rendering frames since the
+// last minute tick, logged as one "prof seconds" line per minute
+static uint32_t s_prof_second_ticks;
+static int32_t s_prof_second_ms, s_prof_frame_ms;
+static int32_t profile_ms(void) {
+  time_t sec;
+  uint16_t ms;
+  time_ms(&sec, &ms);
+  if (!s_launch_s) { s_launch_s = sec; s_launch_ms = ms; }
+  return (int32_t)((sec - s_launch_s) * 1000 + ms - s_launch_ms);
+}
+static void profile_mark(const char *phase) {
+  APP_LOG(APP_LOG_LEVEL_INFO, "prof startup %s +%d ms", phase, (int)profile_ms());
+}
+static void profile_frame_start_proc(Layer *layer, GContext *ctx) {
+  s_frame_start_ms = profile_ms();
+}
+static void profile_frame_end_proc(Layer *layer, GContext *ctx) {
+  if (s_frame_count++ == 0) profile_mark("first frame");
+  int32_t ms = profile_ms() - s_frame_start_ms;
+  s_prof_frame_ms += ms;
+  APP_LOG(APP_LOG_LEVEL_INFO, "prof frame %lu %d ms", (unsigned long)s_frame_count, (int)ms);
+}
+static void profile_seconds_minute(void) {
+  if (s_prof_second_ticks) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "prof seconds %lu ticks, update %d ms, render %d ms",
+            (unsigned long)s_prof_second_ticks, (int)s_prof_second_ms, (int)s_prof_frame_ms);
+  }
+  s_prof_second_ticks = 0;
+  s_prof_second_ms = s_prof_frame_ms = 0;
+}
+// Alert latency: every inbox message is stamped on entry, the urgent-low vibe logs the ms
+// since then and the age of the reading that triggered it
+static int32_t s_prof_inbox_ms;
+static void profile_inbox(void) {
+  s_prof_inbox_ms = profile_ms();
+  APP_LOG(APP_LOG_LEVEL_INFO, "prof inbox +%d ms", (int)s_prof_inbox_ms);
+}
+static void profile_alert(time_t reading_age_s) {
+  APP_LOG(APP_LOG_LEVEL_INFO, "prof alert %d ms after inbox, reading %d s old",
+          (int)(profile_ms() - s_prof_inbox_ms), (int)reading_age_s);
+}
+#else
+#define profile_mark(phase)
+#define profile_inbox()
+#define profile_alert(reading_age_s)
+#endif
+
+// Telemetry export (build with SUPERCGM_TELEMETRY=1): fixed-size records appended to one
+// DataLogging session, which the firmware batches to the phone in the background instead
+// of adding AppMessages next to the BG traffic. The record layout is listed in the README.
+#if defined(TELEMETRY)
+#define TELEMETRY_TAG 0x53434731 // "SCG1"
+#define TELEMETRY_PERIOD_MIN 15
+typedef enum {
+  TELEMETRY_BG = 1,         // a: sgv, b: s from reading to arrival, flags: trend
+  TELEMETRY_DRAWS = 2,      // a: draw_all_rows() calls, b: slots updated since last, flags: idle
+  TELEMETRY_HEALTH = 3,     // a: steps today, b: heart rate or -1
+  TELEMETRY_MSG_FAILED = 4, // a: AppMessageResult, flags: 0 outbox failed, 1 inbox dropped
+  TELEMETRY_OUTAGE = 5      // a: s without the phone app, b: outages since launch
+} TelemetryKind;
+typedef struct __attribute__((packed)) {
+  uint32_t time;
+  uint8_t kind;
+  uint8_t flags;
+  int16_t b;
+  int32_t a;
+} TelemetryRecord;
+static DataLoggingSessionRef s_telemetry;
+static uint32_t s_telemetry_draws, s_telemetry_slots;
+static void telemetry_log(TelemetryKind kind, uint8_t flags, int32_t a, int32_t b) {
+  if (!s_telemetry) return;
+  TelemetryRecord r = {
+    .time = (uint32_t)time(NULL), .kind = (uint8_t)kind, .flags = flags,
+    .b = (int16_t)(b > INT16_MAX ? INT16_MAX : (b < INT16_MIN ? INT16_MIN : b)), .a = a
+  };
+  data_logging_log(s_telemetry, &r, 1);
+}
+#define telemetry_count_draw() (s_telemetry_draws++)
+#define telemetry_count_slot() (s_telemetry_slots++)
+#else
+#define telemetry_log(kind, flags, a, b)
+#define telemetry_count_draw()
+#define telemetry_count_slot()
+#endif
+
 static void update_heart_rate(void) {
 #if defined(PBL_HEALTH)
   time_t now = time(NULL);
@@ -152,31 +370,51 @@ typedef struct {
   int date_format;
   int weekday_lang;
   int temp_unit_f;
+  int weather_interval_min;
   int bg_timeout_min;
   int bg_low;
   int bg_high;
   uint32_t col_low_hex;
   uint32_t col_high_hex;
   uint32_t col_in_hex;
+  uint32_t config_hash; // phone-side hash of the config set last applied; 0 = unknown
+  int bg_urgent_low;
+  int bg_alert_snooze_min;
+  char bg_follow_tags[BG_MAX_PERSONS];
+  int idle_mode;
 } ConfigCache;
+static uint32_t s_config_hash = 0;
+static ConfigCache s_saved_config; // last persisted copy, to skip redundant flash writes
 
 static void save_config_cache(void);
 static void load_config_cache(void);
-
-// Hatch overlay: thin black vertical stripes reduce the fill of the ghost glyphs
+static void save_weather_cache(void);
+static void load_weather_cache(void);
+static void save_bg_cache(void);
+static void load_bg_cache(void);
+
+// Hatch overlay: one window-sized layer over all ghosts that masks each visible ghost
+// slot. Pebble re-renders the whole window on every frame, so this runs on every 1 Hz
+// tick too.
 static void hatch_update_proc(Layer *layer, GContext *ctx) {
 #if defined(PBL_COLOR)
   // No hatch on color (ghost uses mid-grey directly)
   return;
 #endif
-  GRect b = layer_get_bounds(layer);
   graphics_context_set_fill_color(ctx, GColorBlack);
-  // Aggressive 2x2 mask: keep only 1 out of 4 pixels (25%) to make ghost much lighter
-  for (int y = 0; y < b.size.h; y++) {
-    for (int x = 0; x < b.size.w; x++) {
-      // Fill 3 of every 4 pixels (pattern where (x%2,y%2)!=(1,1))
-      if (!((x & 1) && (y & 1))) {
-        graphics_fill_rect(ctx, GRect(x, y, 1, 1), 0, GCornerNone);
+  for (int i = 0; i < ROWS; i++) {
+    for (int c = 0; c < 5; c++) {
+      Layer *ghost = text_layer_get_layer(s_ghost_layers[i][c]);
+      if (layer_get_hidden(ghost)) continue;
+      GRect f = layer_get_frame(ghost);
+      // Aggressive 2x2 mask: keep only 1 out of 4 pixels (25%) to make ghost much lighter.
+      // A pixel is filled when its slot-relative row or column is even, so fill the even
+      // rows and the even columns as spans: 31 rects per 28x33 slot instead of 241
+      for (int y = 0; y < f.size.h; y += 2) {
+        graphics_fill_rect(ctx, GRect(f.origin.x, f.origin.y + y, f.size.w, 1), 0, GCornerNone);
+      }
+      for (int x = 0; x < f.size.w; x += 2) {
+        graphics_fill_rect(ctx, GRect(f.origin.x + x, f.origin.y, 1, f.size.h), 0, GCornerNone);
       }
     }
   }
@@ -220,10 +458,6 @@ static void layout_rows(void) {
   layer_set_frame(text_layer_get_layer(s_ghost_layers[i][c]), frame);
 #endif
       }
-      if (s_ghost_hatch_layers[i][c]) {
-        layer_set_hidden(s_ghost_hatch_layers[i][c], hide);
-        layer_set_frame(s_ghost_hatch_layers[i][c], frame);
-      }
       if (s_digit_layers[i][c]) {
   layer_set_hidden(text_layer_get_layer(s_digit_layers[i][c]), hide);
 #if defined(PBL_ROUND)
@@ -269,6 +503,7 @@ static void layout_rows(void) {
 static void battery_handler(BatteryChargeState state) { draw_all_rows(); }
 
 static void health_handler(HealthEventType event, void *context) {
+  if (s_idle) return; // nothing shown depends on health data while idle
   if (event == HealthEventMovementUpdate) {
     draw_all_rows();
   }
@@ -291,7 +526,135 @@ static void unobstructed_did_change(void *context) {
 }
 #endif
 
+// Temperature to show at `at`: the live reading while it is from that hour, else the
+// cached hourly forecast, else the live reading until it is older than two fetch intervals (min 1h)
+static bool weather_temp_at(time_t at, int *temp) {
+  if (!s_weather.unit) return false;
+  time_t hour_start = at - (at % 3600);
+  if (s_weather.timestamp >= hour_start && s_weather.timestamp <= at) {
+    *temp = s_weather.temp;
+    return true;
+  }
+  if (s_weather.forecast_count > 0 && at >= s_weather.forecast_start) {
+    time_t idx = (at - s_weather.forecast_start) / 3600;
+    if (idx < s_weather.forecast_count && s_weather.forecast[idx] != WEATHER_FORECAST_MISSING) {
+      *temp = s_weather.forecast[idx];
+      return true;
+    }
+  }
+  int stale_min = s_weather_interval_min * 2;
+  if (stale_min < 60) stale_min = 60;
+  if ((at - s_weather.timestamp) <= (time_t)stale_min * 60) {
+    *temp = s_weather.temp;
+    return true;
+  }
+  return false;
+}
+
+static bool is_seconds_row(RowType type) {
+  return type == ROW_TYPE_SECONDS || type == ROW_TYPE_MIN_SEC;
+}
+
+// Fill the 5-slot buffer of a seconds row; shared by the full redraw and the 1 Hz tick
+static void fill_seconds_slots(RowType type, int row, const struct tm *t, char *slots) {
+#if defined(PBL_ROUND)
+  // Round top/bottom rows hide slots 0 and 4: MM:SS falls back to :SS there
+  if (row == 0 || row == ROWS-1) type = ROW_TYPE_SECONDS;
+#endif
+  if (type == ROW_TYPE_MIN_SEC) {
+    // MM:SS – a full HH:MM:SS does not fit the 5-slot grid
+    slots[0] = (char)('0' + t->tm_min / 10);
+    slots[1] = (char)('0' + t->tm_min % 10);
+    slots[2] = ':';
+    slots[3] = (char)('0' + t->tm_sec / 10);
+    slots[4] = (char)('0' + t->tm_sec % 10);
+  } else {
+    // ":SS" centered in slots 1..3 so it also fits the round top/bottom rows
+    slots[1] = ':';
+    slots[2] = (char)('0' + t->tm_sec / 10);
+    slots[3] = (char)('0' + t->tm_sec % 10);
+  }
+}
+
+// Per-second path: touch only the seconds slots whose character changed (usually one,
+// two every ten seconds). Everything else is left to the minute tick's draw_all_rows().
+// Marking one slot dirty still makes Pebble render the whole window, every text layer
+// and the B/W hatch included; that render is the main cost of a seconds row.
+static void update_seconds_rows(const struct tm *t) {
+#if defined(PROFILE_TIMINGS)
+  int32_t start = profile_ms();
+#endif
+  for (int i = 0; i < ROWS; i++) {
+    if (!is_seconds_row(s_row_types[i])) continue;
+    char slots[6] = {' ', ' ', ' ', ' ', ' ', 0};
+    fill_seconds_slots(s_row_types[i], i, t, slots);
+    for (int c = 0; c < 5; c++) {
+      if (s_slot_text[i][c][0] == slots[c]) continue;
+      s_slot_text[i][c][0] = slots[c];
+      if (s_digit_layers[i][c]) layer_mark_dirty(text_layer_get_layer(s_digit_layers[i][c]));
+    }
+  }
+#if defined(PROFILE_TIMINGS)
+  s_prof_second_ticks++;
+  s_prof_second_ms += profile_ms() - start;
+#endif
+}
+
+// Only pay for a 1 Hz wakeup while a seconds row is actually configured
+static void update_tick_subscription(void) {
+  TimeUnits units = MINUTE_UNIT;
+  for (int i = 0; i < ROWS && !s_idle; i++) {
+    if (is_seconds_row(s_row_types[i])) { units = SECOND_UNIT; break; }
+  }
+  if (units == s_tick_units) return;
+  tick_timer_service_subscribe(units, tick_handler);
+  s_tick_units = units;
+}
+
+// Keep BG numeric-only to preserve monospaced grid
+static void format_bg_value(char *buf, size_t size, int sgv) {
+  if (s_bg_unit_mmol) {
+    int mmol10 = (sgv * 10) / 18;
+    int whole = mmol10 / 10;
+    int frac  = mmol10 % 10;
+    snprintf(buf, size, "%d.%d", whole, frac);
+  } else {
+    snprintf(buf, size, "%d", sgv);
+  }
+}
+
+// Signed change in the display unit: "+12" mg/dL or "-0.4" mmol/L
+static void format_bg_delta(char *buf, size_t size, int delta) {
+  char sign = delta < 0 ? '-' : '+';
+  int mag = delta < 0 ? -delta : delta;
+  if (s_bg_unit_mmol) {
+    int mmol10 = (mag * 10 + 9) / 18;
+    snprintf(buf, size, "%c%d.%d", sign, mmol10 / 10, mmol10 % 10);
+  } else {
+    snprintf(buf, size, "%c%d", sign, mag);
+  }
+}
+
+// Tag letter in the first visible slot, value right-aligned in the rest (follower and
+// extras rows). Round top/bottom rows only show slots 1..3. A number is never cut: the
+// tag gives way to a value that needs every slot, and one that does not fit shows "--".
+static void fill_tagged_slots(char *slots, int row, char tag, const char *val) {
+  int first = 0, last = 4;
+#if defined(PBL_ROUND)
+  if (row == 0 || row == ROWS-1) { first = 1; last = 3; }
+#endif
+  size_t room = (size_t)(last - first + 1);
+  size_t l = strlen(val);
+  if (l > room) { val = "--"; l = 2; }
+  if (l < room) slots[first] = tag ? tag : ' ';
+  for (size_t k = 0; k < l; k++) slots[last + 1 - l + k] = val[k];
+}
+
 static void draw_all_rows(void) {
+#if defined(PROFILE_TIMINGS)
+  int32_t draw_start = profile_ms();
+#endif
+  telemetry_count_draw();
   time_t now = time(NULL);
   struct tm *t = localtime(&now);
 
@@ -344,31 +707,27 @@ static void draw_all_rows(void) {
 
   // Current battery and steps snapshot
   BatteryChargeState batt_state = battery_state_service_peek();
-  HealthValue steps_now = health_service_sum_today(HealthMetricStepCount);
-  update_heart_rate();
+  HealthValue steps_now = 0;
+  if (!s_idle) {
+    steps_now = health_service_sum_today(HealthMetricStepCount);
+    update_heart_rate();
+  }
 
   // BG line
+  // Without the phone, its last status (NOCONN included) is as out of date as the reading
   static char s_bg[16];
-  if (s_bg_status == BG_STATUS_CONN_ERROR) {
+  bool bg_valid = s_bg_status == BG_STATUS_OK && s_bg_sgv >= 0;
+  bool bg_stale = (int)((now - s_bg_timestamp) / 60) > s_bg_timeout_min;
+  if (!s_connected && (!bg_valid || bg_stale)) {
+    snprintf(s_bg, sizeof(s_bg), "NO-BT");
+  } else if (s_bg_status == BG_STATUS_CONN_ERROR) {
     snprintf(s_bg, sizeof(s_bg), "NOCONN");
-  } else if (s_bg_status == BG_STATUS_NO_DATA || s_bg_sgv < 0) {
+  } else if (!bg_valid) {
     snprintf(s_bg, sizeof(s_bg), "NO-BG");
+  } else if (bg_stale) {
+    snprintf(s_bg, sizeof(s_bg), "NOCON");
   } else {
-    // staleness
-    int age_min = (int)((now - s_bg_timestamp) / 60);
-    if (age_min > s_bg_timeout_min) {
-      snprintf(s_bg, sizeof(s_bg), "NOCON");
-    } else {
-      // Keep BG numeric-only to preserve monospaced grid
-      if (s_bg_unit_mmol) {
-        int mmol10 = (s_bg_sgv * 10) / 18;
-        int whole = mmol10 / 10;
-        int frac  = mmol10 % 10;
-        snprintf(s_bg, sizeof(s_bg), "%d.%d", whole, frac);
-      } else {
-        snprintf(s_bg, sizeof(s_bg), "%d", s_bg_sgv);
-      }
-    }
+    format_bg_value(s_bg, sizeof(s_bg), s_bg_sgv);
   }
 
   // Battery
@@ -488,28 +847,66 @@ static void draw_all_rows(void) {
         }
         break;
       }
-  case ROW_TYPE_WEATHER: {
-        // Ensure default and fit into grid; parse degree/unit and place into slots
-        if (strlen(s_weather_buf) == 0) {
-          snprintf(s_weather_buf, sizeof(s_weather_buf), "--");
+  case ROW_TYPE_BG_PERSON2:
+  case ROW_TYPE_BG_PERSON3: {
+        // Tag letter in the first slot, value right-aligned after it; the trend arrow
+        // stays with the wearer's own BG row
+        int f = s_row_types[i] - ROW_TYPE_BG_PERSON2;
+        const BgPerson *p = &s_bg_follow[f];
+        char val[8];
+        if (p->status == BG_STATUS_OK && p->sgv >= 0 && (now - p->timestamp) / 60 <= s_bg_timeout_min) {
+          format_bg_value(val, sizeof(val), p->sgv);
+          if (p->sgv < s_bg_low) color = s_col_low;
+          else if (p->sgv > s_bg_high) color = s_col_high;
+          else color = s_col_in;
+        } else {
+          strcpy(val, "--");
         }
-        // build temp without '°' to get numeric; keep unit as letter
-        char temp_no_deg[8]; size_t p = 0;
-        for (size_t q = 0; q < strlen(s_weather_buf) && p < sizeof(temp_no_deg)-1; q++) {
-          // UTF-8 degree 0xC2 0xB0
-          if ((unsigned char)s_weather_buf[q] == 0xC2 && (unsigned char)s_weather_buf[q+1] == 0xB0) { q++; continue; }
-          if ((unsigned char)s_weather_buf[q] == 0xB0) { continue; }
-          temp_no_deg[p++] = s_weather_buf[q];
+        fill_tagged_slots(slots, i, s_bg_follow_tags[f], val);
+        break;
+      }
+  case ROW_TYPE_BG_DELTA:
+  case ROW_TYPE_IOB:
+  case ROW_TYPE_COB:
+  case ROW_TYPE_BG_RAW: {
+        // Shown for as long as the reading they came with
+        static const char tags[] = "DICR";
+        int16_t v = BG_EXTRA_UNKNOWN;
+        switch (s_row_types[i]) {
+          case ROW_TYPE_BG_DELTA: v = s_bg_extras.delta; break;
+          case ROW_TYPE_IOB: v = s_bg_extras.iob10; break;
+          case ROW_TYPE_COB: v = s_bg_extras.cob; break;
+          default: v = s_bg_extras.raw; break;
         }
-        temp_no_deg[p] = 0;
-        // Identify trailing unit (C/F) and separate it
-        size_t l2 = strlen(temp_no_deg);
+        char val[8];
+        if (v == BG_EXTRA_UNKNOWN || (now - s_bg_extras.timestamp) / 60 > s_bg_timeout_min) {
+          strcpy(val, "--");
+        } else if (s_row_types[i] == ROW_TYPE_BG_DELTA) {
+          format_bg_delta(val, sizeof(val), v);
+        } else if (s_row_types[i] == ROW_TYPE_IOB) {
+          int mag = v < 0 ? -v : v;
+          snprintf(val, sizeof(val), "%s%d.%d", v < 0 ? "-" : "", mag / 10, mag % 10);
+        } else if (s_row_types[i] == ROW_TYPE_COB) {
+          snprintf(val, sizeof(val), "%d", v);
+        } else {
+          format_bg_value(val, sizeof(val), v);
+        }
+        fill_tagged_slots(slots, i, tags[s_row_types[i] - ROW_TYPE_BG_DELTA], val);
+        break;
+      }
+  case ROW_TYPE_WEATHER: {
+        // Numeric temperature and unit letter go straight into the slots; degree is drawn via overlay.
+        // Missing or stale weather shows "--"
+        char temp_no_deg[8];
         char unit_char = 0;
-        if (l2 > 0 && (temp_no_deg[l2-1] == 'C' || temp_no_deg[l2-1] == 'F')) {
-          unit_char = temp_no_deg[l2-1];
-          temp_no_deg[l2-1] = 0; // remove unit from numeric string
-          l2--;
+        int weather_temp;
+        if (weather_temp_at(now, &weather_temp)) {
+          snprintf(temp_no_deg, sizeof(temp_no_deg), "%d", weather_temp);
+          unit_char = s_weather.unit;
+        } else {
+          strcpy(temp_no_deg, "--");
         }
+        size_t l2 = strlen(temp_no_deg);
         // Place into slots based on platform; draw degree via overlay circle
         if (s_weather_deg_layer) layer_set_hidden(s_weather_deg_layer, true);
 
@@ -547,7 +944,7 @@ static void draw_all_rows(void) {
 #endif
   // Position and show degree overlay (small circle) only on rectangular screens.
 #if !defined(PBL_ROUND)
-  if (s_weather_deg_layer) {
+  if (s_weather_deg_layer && !s_idle) {
     GRect bounds = get_layout_bounds();
     int16_t row_h = bounds.size.h / ROWS;
     int16_t slot_w = bounds.size.w / 5;
@@ -565,33 +962,34 @@ static void draw_all_rows(void) {
         break;
       }
       case ROW_TYPE_STEPS:
-        strncpy(slots, s_steps, 5);
+        if (!s_idle) strncpy(slots, s_steps, 5);
         break;
       case ROW_TYPE_HEART_RATE:
-        strncpy(slots, s_hr, 5);
+        if (!s_idle) strncpy(slots, s_hr, 5);
+        break;
+      case ROW_TYPE_SECONDS:
+      case ROW_TYPE_MIN_SEC:
+        if (!s_idle) fill_seconds_slots(s_row_types[i], i, t, slots);
         break;
     }
 
-    // Apply to slots and set fonts/colors
+    // Apply to slots and set fonts/colors. After the first pass only slots whose character
+    // or color changed are touched, so a minute tick usually dirties just the minute digits.
     for (int c = 0; c < 5; c++) {
+      if (s_slots_styled && s_slot_text[i][c][0] == slots[c] && gcolor_equal(s_slot_color[i][c], color)) {
+        continue;
+      }
+      telemetry_count_slot();
       // Prepare persistent buffer for this slot
       s_slot_text[i][c][0] = slots[c];
       s_slot_text[i][c][1] = 0;
-      // Ghost always "8"
-      if (s_ghost_layers[i][c]) {
-        text_layer_set_text(s_ghost_layers[i][c], "8");
-        text_layer_set_text_color(s_ghost_layers[i][c], s_ghost_color);
-        // Use smaller font on round for top/bottom rows
-#if defined(PBL_ROUND)
-        if (i == 0 || i == ROWS-1) {
-          if (s_font_dseg_25_reg) text_layer_set_font(s_ghost_layers[i][c], s_font_dseg_25_reg);
-        } else {
-          if (s_font_dseg_29_reg) text_layer_set_font(s_ghost_layers[i][c], s_font_dseg_29_reg);
-          else if (s_font_dseg_30_reg) text_layer_set_font(s_ghost_layers[i][c], s_font_dseg_30_reg);
+      s_slot_color[i][c] = color;
+      if (s_slots_styled) {
+        if (s_digit_layers[i][c]) {
+          text_layer_set_text_color(s_digit_layers[i][c], color);
+          layer_mark_dirty(text_layer_get_layer(s_digit_layers[i][c]));
         }
-#else
-        if (s_font_dseg_30_reg) text_layer_set_font(s_ghost_layers[i][c], s_font_dseg_30_reg);
-#endif
+        continue;
       }
       if (s_digit_layers[i][c]) {
         text_layer_set_text(s_digit_layers[i][c], s_slot_text[i][c]);
@@ -613,45 +1011,221 @@ static void draw_all_rows(void) {
       }
     }
   }
+  if (s_digit_layers[0][0]) s_slots_styled = true;
+#if defined(PROFILE_TIMINGS)
+  APP_LOG(APP_LOG_LEVEL_INFO, "prof draw %d ms idle=%d", (int)(profile_ms() - draw_start), (int)s_idle);
+#endif
+}
+
+// Ghost "8"s are not needed for the first frame; styled once their fonts are loaded
+static void style_ghost_layers(void) {
+  for (int i = 0; i < ROWS; i++) {
+    for (int c = 0; c < 5; c++) {
+      if (!s_ghost_layers[i][c]) continue;
+      GFont font = s_font_dseg_30_reg;
+#if defined(PBL_ROUND)
+      // Use smaller font on round for top/bottom rows
+      font = (i == 0 || i == ROWS-1) ? s_font_dseg_25_reg : s_font_dseg_29_reg;
+#endif
+      text_layer_set_text_color(s_ghost_layers[i][c], s_ghost_color);
+      if (font) text_layer_set_font(s_ghost_layers[i][c], font);
+      text_layer_set_text(s_ghost_layers[i][c], "8");
+    }
+  }
+}
+
+static void enter_idle_if_due(time_t now) {
+  if (s_idle || !s_idle_enabled) return;
+  int after_min = IDLE_AFTER_MIN;
+#if PBL_API_EXISTS(quiet_time_is_active)
+  if (quiet_time_is_active()) after_min = IDLE_AFTER_MIN_QUIET;
+#endif
+  if (now - s_last_flick < (time_t)after_min * 60) return;
+  s_idle = true;
+  update_tick_subscription();
+}
+
+// Wrist flick: restore the full face right away so it is complete in the next frame
+static void accel_tap_handler(AccelAxisType axis, int32_t direction) {
+  s_last_flick = time(NULL);
+  if (!s_idle) return;
+  s_idle = false;
+  update_tick_subscription();
+  draw_all_rows();
 }
 
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
   if (units_changed & MINUTE_UNIT) {
+#if defined(PROFILE_TIMINGS)
+    profile_seconds_minute();
+#endif
     update_time();
+  } else if (units_changed & SECOND_UNIT) {
+    update_seconds_rows(tick_time);
   }
 }
 
+#if defined(TELEMETRY)
+// Redraw counts every TELEMETRY_PERIOD_MIN; health only when not idle (no queries then)
+static void telemetry_periodic(time_t now) {
+  if ((now / 60) % TELEMETRY_PERIOD_MIN) return;
+  telemetry_log(TELEMETRY_DRAWS, s_idle, (int32_t)s_telemetry_draws, (int32_t)s_telemetry_slots);
+  s_telemetry_draws = s_telemetry_slots = 0;
+  if (s_idle) return;
+  bool hr_fresh = s_hr_bpm > 0 && now - s_hr_timestamp <= 300;
+  telemetry_log(TELEMETRY_HEALTH, 0, (int32_t)health_service_sum_today(HealthMetricStepCount), hr_fresh ? s_hr_bpm : -1);
+}
+#endif
+
 static void update_time(void) {
+  enter_idle_if_due(time(NULL));
   draw_all_rows();
-  // ask for updates
-  request_weather();
+  if (s_hello_pending && !s_hello_in_flight) send_hello(); // no-op while disconnected
+#if defined(TELEMETRY)
+  telemetry_periodic(time(NULL));
+#endif
+  // Ask for weather only when the cache (live reading or forecast) is about to run out;
+  // the phone pushes fresh data on its own interval.
+  time_t now = time(NULL);
+  bool has_weather_row = false;
+  for (int i = 0; i < ROWS; i++) if (s_row_types[i] == ROW_TYPE_WEATHER) { has_weather_row = true; break; }
+  int temp;
+  if (has_weather_row && !s_idle && s_connected && !s_hello_pending && !weather_temp_at(now + 15 * 60, &temp) &&
+      (now - s_weather_requested_at) >= WEATHER_REQUEST_GAP_S) {
+    request_weather();
+  }
   // BG fetching is scheduled on the phone side at a configurable interval
 }
 
 // Messaging
+// Urgent-low alert. Checked first thing in the inbox handler, before any state update or
+// redraw, so the vibration is queued as soon as the reading arrives. Fires when the
+// reading or its 15 min extrapolation is below s_bg_urgent_low; repeats after the snooze
+// while still low and re-arms only once the reading is back above urgent low + margin.
+#define PERSIST_ALERT_KEY 1003
+#define BG_ALERT_LOOKAHEAD_MIN 15
+#define BG_ALERT_REARM_MARGIN 10 // mg/dL
+typedef struct {
+  int version;
+  bool active;       // inside an urgent-low episode
+  time_t last_alert; // when we last vibrated for it
+} AlertState;
+static AlertState s_alert = { .version = 1 };
+
+// mg/dL per 5 min implied by each trend arrow, for when there is no previous reading to diff
+static const int8_t s_trend_rate_per5[BG_TREND_COUNT] = {
+  [BG_TREND_DOUBLE_UP] = 15, [BG_TREND_SINGLE_UP] = 10, [BG_TREND_FORTY_FIVE_UP] = 5,
+  [BG_TREND_FORTY_FIVE_DOWN] = -5, [BG_TREND_SINGLE_DOWN] = -10, [BG_TREND_DOUBLE_DOWN] = -15
+};
+static const uint32_t s_urgent_low_vibe[] = { 500, 150, 500, 150, 500, 150, 900 };
+
+static void check_urgent_low(DictionaryIterator *iter) {
+  Tuple *sgv_t = dict_find(iter, MESSAGE_KEY_BG_SGV);
+  if (!sgv_t || s_bg_urgent_low <= 0) return;
+  Tuple *ts_t = dict_find(iter, MESSAGE_KEY_BG_TIMESTAMP);
+  Tuple *trend_t = dict_find(iter, MESSAGE_KEY_BG_TREND);
+  time_t now = time(NULL);
+  int sgv = (int)sgv_t->value->int32;
+  time_t ts = ts_t ? (time_t)ts_t->value->int32 : now;
+  if (sgv < 0 || now - ts > s_bg_timeout_min * 60) return; // old news, e.g. a launch snapshot
+
+  // Rate from the previous reading when it is recent, else from the arrow
+  int per5 = 0;
+  if (s_bg_sgv >= 0 && ts > s_bg_timestamp && ts - s_bg_timestamp <= 15 * 60) {
+    per5 = (sgv - s_bg_sgv) * 300 / (int)(ts - s_bg_timestamp);
+  } else if (trend_t && trend_t->value->int32 > BG_TREND_NONE && trend_t->value->int32 < BG_TREND_COUNT) {
+    per5 = s_trend_rate_per5[trend_t->value->int32];
+  }
+  int predicted = sgv + per5 * BG_ALERT_LOOKAHEAD_MIN / 5;
+
+  if (sgv >= s_bg_urgent_low && predicted >= s_bg_urgent_low) {
+    if (s_alert.active && sgv >= s_bg_urgent_low + BG_ALERT_REARM_MARGIN) {
+      s_alert.active = false;
+      persist_write_data(PERSIST_ALERT_KEY, &s_alert, sizeof(s_alert));
+    }
+    return;
+  }
+  if (s_alert.active && now - s_alert.last_alert < s_bg_alert_snooze_min * 60) return;
+  profile_alert(now - ts);
+  vibes_enqueue_custom_pattern((VibePattern) {
+    .durations = s_urgent_low_vibe,
+    .num_segments = ARRAY_LENGTH(s_urgent_low_vibe)
+  });
+  s_alert.active = true;
+  s_alert.last_alert = now;
+  persist_write_data(PERSIST_ALERT_KEY, &s_alert, sizeof(s_alert));
+}
+
+static void load_alert_state(void) {
+  AlertState a;
+  if (persist_read_data(PERSIST_ALERT_KEY, &a, sizeof(a)) == (int)sizeof(a) && a.version == 1) s_alert = a;
+}
+
+static void send_config_hash(void) {
+  DictionaryIterator *iter;
+  if (app_message_outbox_begin(&iter) == APP_MSG_OK) {
+    dict_write_uint32(iter, MESSAGE_KEY_CONFIG_HASH, s_config_hash);
+    app_message_outbox_send();
+  }
+}
+
 static void inbox_received_callback(DictionaryIterator *iter, void *context) {
   Tuple *t;
+  profile_inbox();
 
-  if ((t = dict_find(iter, MESSAGE_KEY_WEATHER_TEMP))) {
-    // Put temp with unit symbol in any weather row
-    char symbol = s_temp_unit_f ? 'F' : 'C';
-    snprintf(s_weather_buf, sizeof(s_weather_buf), "%ld°%c", t->value->int32, symbol);
-  // Re-render rows; per-slot renderer will place it appropriately
-  draw_all_rows();
+  // Alert before anything else touches the message
+  check_urgent_low(iter);
+
+  // The phone came up after our launch HELLO went nowhere: say hello again
+  if (dict_find(iter, MESSAGE_KEY_HELLO)) {
+    if (!s_hello_in_flight) send_hello();
+    return;
   }
-  if ((t = dict_find(iter, MESSAGE_KEY_BG_SGV))) {
-    s_bg_sgv = (int)t->value->int32;
+
+  // Config sync handshake: the phone either asks for our hash (query) or sends changed
+  // keys against a base hash. A query, or a diff against a config we do not have, is
+  // answered with our hash so the phone can follow up with the right set.
+  Tuple *hash_t = dict_find(iter, MESSAGE_KEY_CONFIG_HASH);
+  if (hash_t) {
+    Tuple *base_t = dict_find(iter, MESSAGE_KEY_CONFIG_BASE_HASH);
+    bool query = dict_find(iter, MESSAGE_KEY_CONFIG_QUERY) != NULL;
+    if (query || (base_t && base_t->value->uint32 != s_config_hash)) {
+      if (hash_t->value->uint32 != s_config_hash) send_config_hash();
+      return;
+    }
   }
+
   if ((t = dict_find(iter, MESSAGE_KEY_TEMP_UNIT))) {
     s_temp_unit_f = t->value->int32 ? 1 : 0;
   }
-
-  // If weather not provided in this message but a weather row exists and no previous string, set default '--'
-  bool has_weather_row = false;
-  for (int i=0;i<ROWS;i++) if (s_row_types[i]==ROW_TYPE_WEATHER) { has_weather_row=true; break; }
-  if (has_weather_row && strlen(s_weather_buf) == 0) {
-    snprintf(s_weather_buf, sizeof(s_weather_buf), "--");
-  draw_all_rows();
+  if ((t = dict_find(iter, MESSAGE_KEY_WEATHER_TEMP))) {
+    char unit = s_temp_unit_f ? 'F' : 'C';
+    // A forecast in the other unit is useless; one in the same unit stays valid
+    if (unit != s_weather.unit) s_weather.forecast_count = 0;
+    s_weather.temp = (int16_t)t->value->int32;
+    s_weather.unit = unit;
+    s_weather.timestamp = time(NULL);
+    s_weather.code = s_weather.high = s_weather.low = WEATHER_UNKNOWN;
+    if ((t = dict_find(iter, MESSAGE_KEY_WEATHER_TIMESTAMP))) s_weather.timestamp = (time_t)t->value->int32;
+    if ((t = dict_find(iter, MESSAGE_KEY_WEATHER_CODE))) s_weather.code = (int16_t)t->value->int32;
+    if ((t = dict_find(iter, MESSAGE_KEY_WEATHER_HIGH))) s_weather.high = (int16_t)t->value->int32;
+    if ((t = dict_find(iter, MESSAGE_KEY_WEATHER_LOW))) s_weather.low = (int16_t)t->value->int32;
+    Tuple *fc = dict_find(iter, MESSAGE_KEY_WEATHER_FORECAST);
+    Tuple *fc_start = dict_find(iter, MESSAGE_KEY_WEATHER_FORECAST_START);
+    if (fc && fc_start && fc->type == TUPLE_BYTE_ARRAY) {
+      uint16_t n = fc->length;
+      if (n > WEATHER_FORECAST_HOURS) n = WEATHER_FORECAST_HOURS;
+      memcpy(s_weather.forecast, fc->value->data, n);
+      s_weather.forecast_count = (uint8_t)n;
+      s_weather.forecast_start = (time_t)fc_start->value->int32;
+    }
+    save_weather_cache();
+  }
+  if ((t = dict_find(iter, MESSAGE_KEY_WEATHER_INTERVAL_MIN))) {
+    s_weather_interval_min = t->value->int32 > 0 ? (int)t->value->int32 : 30;
+  }
+  if ((t = dict_find(iter, MESSAGE_KEY_BG_SGV))) {
+    s_bg_sgv = (int)t->value->int32;
   }
   if ((t = dict_find(iter, MESSAGE_KEY_BG_TIMESTAMP))) {
     s_bg_timestamp = (time_t)t->value->int32;
@@ -660,18 +1234,57 @@ static void inbox_received_callback(DictionaryIterator *iter, void *context) {
     s_bg_status = (BgStatus)t->value->int32;
     if (s_bg_status != BG_STATUS_OK) {
       s_bg_sgv = -1;
-      s_bg_trend[0] = 0;
+      s_bg_trend = BG_TREND_NONE;
     }
   }
   if ((t = dict_find(iter, MESSAGE_KEY_BG_UNIT))) {
     s_bg_unit_mmol = t->value->int32 ? 1 : 0;
   }
   if ((t = dict_find(iter, MESSAGE_KEY_BG_TREND))) {
-    strncpy(s_bg_trend, t->value->cstring, sizeof(s_bg_trend));
-    s_bg_trend[sizeof(s_bg_trend)-1] = 0;
+    int32_t trend = (t->type == TUPLE_CSTRING) ? BG_TREND_NONE : t->value->int32;
+    s_bg_trend = (trend > BG_TREND_NONE && trend < BG_TREND_COUNT) ? (BgTrend)trend : BG_TREND_NONE;
+  }
+  if (dict_find(iter, MESSAGE_KEY_BG_SGV)) {
+    telemetry_log(TELEMETRY_BG, (uint8_t)s_bg_trend, s_bg_sgv, (int32_t)(time(NULL) - s_bg_timestamp));
+  }
+  if ((t = dict_find(iter, MESSAGE_KEY_BG_FOLLOW)) && t->type == TUPLE_BYTE_ARRAY) {
+    for (uint16_t off = 0; off + BG_FOLLOW_RECORD_SIZE <= t->length; off += BG_FOLLOW_RECORD_SIZE) {
+      const uint8_t *r = t->value->data + off;
+      if (r[0] >= BG_MAX_PERSONS - 1) continue;
+      BgPerson *p = &s_bg_follow[r[0]];
+      p->status = (BgStatus)r[1];
+      p->trend = r[2] < BG_TREND_COUNT ? (BgTrend)r[2] : BG_TREND_NONE;
+      p->sgv = (int16_t)(r[3] | (r[4] << 8));
+      p->timestamp = (time_t)(r[5] | (r[6] << 8) | (r[7] << 16) | ((uint32_t)r[8] << 24));
+    }
+  }
+  if (dict_find(iter, MESSAGE_KEY_BG_SGV) && !dict_find(iter, MESSAGE_KEY_BG_EXTRAS) &&
+      s_bg_timestamp != s_bg_extras.timestamp) {
+    // A newer reading without extras: the old ones no longer belong to what is on screen
+    s_bg_extras = (BgExtras) { BG_EXTRA_UNKNOWN, BG_EXTRA_UNKNOWN, BG_EXTRA_UNKNOWN, BG_EXTRA_UNKNOWN, s_bg_timestamp };
+  }
+  if ((t = dict_find(iter, MESSAGE_KEY_BG_EXTRAS)) && t->type == TUPLE_BYTE_ARRAY && t->length >= BG_EXTRAS_SIZE) {
+    const uint8_t *d = t->value->data;
+    s_bg_extras.delta = (int16_t)(d[0] | (d[1] << 8));
+    s_bg_extras.iob10 = (int16_t)(d[2] | (d[3] << 8));
+    s_bg_extras.cob = (int16_t)(d[4] | (d[5] << 8));
+    s_bg_extras.raw = (int16_t)(d[6] | (d[7] << 8));
+    s_bg_extras.timestamp = s_bg_timestamp;
+  }
+  if (dict_find(iter, MESSAGE_KEY_BG_SGV) || dict_find(iter, MESSAGE_KEY_BG_STATUS) || dict_find(iter, MESSAGE_KEY_BG_UNIT)) {
+    save_bg_cache();
   }
 
   // Config
+  if ((t = dict_find(iter, MESSAGE_KEY_IDLE_MODE))) {
+    s_idle_enabled = t->value->int32 != 0;
+    // Count the idle delay from now; switching it off restores the full face
+    s_last_flick = time(NULL);
+    if (!s_idle_enabled && s_idle) {
+      s_idle = false;
+      update_tick_subscription();
+    }
+  }
   if ((t = dict_find(iter, MESSAGE_KEY_SHOW_LEADING_ZERO))) {
     s_show_leading_zero = t->value->int32 != 0;
   }
@@ -690,6 +1303,16 @@ static void inbox_received_callback(DictionaryIterator *iter, void *context) {
   if ((t = dict_find(iter, MESSAGE_KEY_BG_THRESH_HIGH))) {
     s_bg_high = t->value->int32;
   }
+  if ((t = dict_find(iter, MESSAGE_KEY_BG_URGENT_LOW))) {
+    s_bg_urgent_low = t->value->int32;
+  }
+  if ((t = dict_find(iter, MESSAGE_KEY_BG_ALERT_SNOOZE_MIN))) {
+    s_bg_alert_snooze_min = t->value->int32;
+  }
+  if ((t = dict_find(iter, MESSAGE_KEY_BG_FOLLOW_TAGS))) {
+    strncpy(s_bg_follow_tags, t->value->cstring, sizeof(s_bg_follow_tags) - 1);
+    s_bg_follow_tags[sizeof(s_bg_follow_tags) - 1] = 0;
+  }
   if ((t = dict_find(iter, MESSAGE_KEY_COLOR_LOW))) {
   s_col_low_hex = (uint32_t)t->value->int32; s_col_low = ColorFromHex(s_col_low_hex);
   }
@@ -723,28 +1346,89 @@ static void inbox_received_callback(DictionaryIterator *iter, void *context) {
     if ((t = dict_find(iter, key_type))) s_row_types[i] = (RowType)t->value->int32;
     if ((t = dict_find(iter, key_color))) { s_row_color_hex[i] = (uint32_t)t->value->int32; s_row_colors[i] = ColorFromHex(s_row_color_hex[i]); }
   }
+  update_tick_subscription();
+  if (hash_t) s_config_hash = hash_t->value->uint32;
 
   draw_all_rows();
 
-  // persist after applying
+  // persist after applying (no-op when nothing config-related changed)
   save_config_cache();
+
+  // Echo the hash of an applied config: only then does the phone diff against it
+  if (hash_t) send_config_hash();
+}
+
+static void inbox_dropped_callback(AppMessageResult reason, void *context) {
+  telemetry_log(TELEMETRY_MSG_FAILED, 1, reason, 0);
+}
+
+// Startup HELLO (see s_hello_pending)
+static void send_hello(void) {
+  DictionaryIterator *iter;
+  if (!s_connected) return;
+  // Outbox busy: s_hello_pending stays set and the next sent/failed callback or tick retries
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) return;
+  dict_write_int32(iter, MESSAGE_KEY_HELLO, 1);
+  dict_write_uint32(iter, MESSAGE_KEY_CONFIG_HASH, s_config_hash);
+  dict_write_int32(iter, MESSAGE_KEY_WEATHER_TIMESTAMP, s_weather.unit ? (int32_t)s_weather.timestamp : 0);
+  dict_write_int32(iter, MESSAGE_KEY_BG_TIMESTAMP, s_bg_sgv >= 0 ? (int32_t)s_bg_timestamp : 0);
+  s_hello_in_flight = true;
+  if (app_message_outbox_send() != APP_MSG_OK) s_hello_in_flight = false;
+}
+
+static void outbox_failed_callback(DictionaryIterator *iter, AppMessageResult reason, void *context) {
+  telemetry_log(TELEMETRY_MSG_FAILED, 0, reason, 0);
+  // No phone app yet: fall back to asking for weather ourselves until it pings. Lost to a
+  // disconnect instead: the reconnect sends it again.
+  if (!dict_find(iter, MESSAGE_KEY_HELLO)) {
+    if (s_hello_pending && !s_hello_in_flight) send_hello();
+    return;
+  }
+  s_hello_in_flight = false;
+  if (connection_service_peek_pebble_app_connection()) s_hello_pending = false;
 }
 
-static void inbox_dropped_callback(AppMessageResult reason, void *context) {}
-static void outbox_failed_callback(DictionaryIterator *iter, AppMessageResult reason, void *context) {}
-static void outbox_sent_callback(DictionaryIterator *iter, void *context) {}
+static void outbox_sent_callback(DictionaryIterator *iter, void *context) {
+  // The phone has the HELLO; its snapshot covers the weather request
+  if (dict_find(iter, MESSAGE_KEY_HELLO)) {
+    s_hello_pending = s_hello_in_flight = false;
+    s_weather_requested_at = time(NULL);
+  } else if (s_hello_pending && !s_hello_in_flight) {
+    send_hello(); // its last attempt found the outbox busy
+  }
+}
+
+static void app_connection_handler(bool connected) {
+  if (connected == s_connected) return;
+  s_connected = connected;
+  time_t now = time(NULL);
+  if (!connected) {
+    s_disconnected_at = now;
+  } else {
+    s_disconnected_total_s += (uint32_t)(now - s_disconnected_at);
+    s_outages++;
+    telemetry_log(TELEMETRY_OUTAGE, 0, (int32_t)(now - s_disconnected_at), s_outages);
+#if defined(PROFILE_TIMINGS)
+    APP_LOG(APP_LOG_LEVEL_INFO, "prof disconnected %d s, %d s since launch",
+            (int)(now - s_disconnected_at), (int)s_disconnected_total_s);
+#endif
+    // One catch-up for everything; the weather request waits for its snapshot
+    s_hello_pending = true;
+    send_hello();
+  }
+  draw_all_rows();
+}
 
 static void request_weather(void) {
   DictionaryIterator *iter;
   if (app_message_outbox_begin(&iter) == APP_MSG_OK) {
     dict_write_int32(iter, MESSAGE_KEY_REQUEST_WEATHER, 1);
     app_message_outbox_send();
+    s_weather_requested_at = time(NULL);
   }
 }
 
 static void main_window_load(Window *window) {
-  // Stelle sicher, dass die gespeicherte Konfiguration geladen wird
-  load_config_cache();
   Layer *window_layer = window_get_root_layer(window);
   GRect bounds = layer_get_bounds(window_layer);
 
@@ -754,27 +1438,21 @@ static void main_window_load(Window *window) {
   for (int i = 0; i < ROWS; i++) {
     for (int c = 0; c < 5; c++) {
       GRect frame = GRect(left_pad + c * slot_w, i * row_h, slot_w, row_h);
-      // Ghost layer
+      // Ghost layer; text and font are set by style_ghost_layers() after the first frame
       s_ghost_layers[i][c] = text_layer_create(frame);
       text_layer_set_background_color(s_ghost_layers[i][c], GColorClear);
       text_layer_set_text_alignment(s_ghost_layers[i][c], GTextAlignmentCenter);
-  text_layer_set_text_color(s_ghost_layers[i][c], s_ghost_color);
-#if defined(PBL_PLATFORM_APLITE)
-  text_layer_set_text_color(s_ghost_layers[i][c], GColorWhite);
-#endif
-      text_layer_set_text(s_ghost_layers[i][c], "8");
-  if (s_font_dseg_30_reg) text_layer_set_font(s_ghost_layers[i][c], s_font_dseg_30_reg);
       layer_add_child(window_layer, text_layer_get_layer(s_ghost_layers[i][c]));
-  // Hatch overlay above ghost, below foreground
-  s_ghost_hatch_layers[i][c] = layer_create(frame);
-  layer_set_update_proc(s_ghost_hatch_layers[i][c], hatch_update_proc);
-  layer_add_child(window_layer, s_ghost_hatch_layers[i][c]);
-      // Foreground layer
+    }
+  }
+  // Digits go above all ghosts so a single hatch layer fits between the two
+  for (int i = 0; i < ROWS; i++) {
+    for (int c = 0; c < 5; c++) {
+      GRect frame = GRect(left_pad + c * slot_w, i * row_h, slot_w, row_h);
+      // Foreground layer; font and color come from the first draw_all_rows()
       s_digit_layers[i][c] = text_layer_create(frame);
       text_layer_set_background_color(s_digit_layers[i][c], GColorClear);
       text_layer_set_text_alignment(s_digit_layers[i][c], GTextAlignmentCenter);
-      text_layer_set_text_color(s_digit_layers[i][c], GColorWhite);
-      if (s_font_dseg_30) text_layer_set_font(s_digit_layers[i][c], s_font_dseg_30);
       layer_add_child(window_layer, text_layer_get_layer(s_digit_layers[i][c]));
     }
   }
@@ -791,8 +1469,27 @@ static void main_window_load(Window *window) {
   layer_set_update_proc(s_weather_deg_layer, weather_deg_update_proc);
   layer_add_child(window_layer, s_weather_deg_layer);
 
-  layout_rows();
-  draw_all_rows();
+#if defined(PROFILE_TIMINGS)
+  // Children render in insertion order: one probe below everything, one above
+  Layer *probe = layer_create(GRect(0, 0, 1, 1));
+  layer_set_update_proc(probe, profile_frame_start_proc);
+  layer_insert_below_sibling(probe, text_layer_get_layer(s_ghost_layers[0][0]));
+  probe = layer_create(GRect(0, 0, 1, 1));
+  layer_set_update_proc(probe, profile_frame_end_proc);
+  layer_add_child(window_layer, probe);
+#endif
+  // Layout and the first draw happen in main_window_appear()
+}
+
+// Hatch overlay above the ghosts, below the digits. Only B/W needs it (color uses a
+// mid-grey ghost), and not before the ghosts are drawn
+static void create_hatch_layer(void) {
+#if !defined(PBL_COLOR)
+  Layer *window_layer = window_get_root_layer(s_main_window);
+  s_ghost_hatch_layer = layer_create(layer_get_bounds(window_layer));
+  layer_set_update_proc(s_ghost_hatch_layer, hatch_update_proc);
+  layer_insert_above_sibling(s_ghost_hatch_layer, text_layer_get_layer(s_ghost_layers[ROWS-1][4]));
+#endif
 }
 
 static void main_window_appear(Window *window) {
@@ -815,14 +1512,14 @@ static void force_redraw_layers(void) {
       if (s_ghost_layers[i][c]) {
         layer_mark_dirty(text_layer_get_layer(s_ghost_layers[i][c]));
       }
-      if (s_ghost_hatch_layers[i][c]) {
-        layer_mark_dirty(s_ghost_hatch_layers[i][c]);
-      }
       if (s_digit_layers[i][c]) {
         layer_mark_dirty(text_layer_get_layer(s_digit_layers[i][c]));
       }
     }
   }
+  if (s_ghost_hatch_layer) {
+    layer_mark_dirty(s_ghost_hatch_layer);
+  }
   if (s_bg_trend_layer) {
     layer_mark_dirty(s_bg_trend_layer);
   }
@@ -834,11 +1531,11 @@ static void force_redraw_layers(void) {
 static void main_window_unload(Window *window) {
   for (int i = 0; i < ROWS; i++) {
     for (int c = 0; c < 5; c++) {
-  if (s_ghost_hatch_layers[i][c]) { layer_destroy(s_ghost_hatch_layers[i][c]); s_ghost_hatch_layers[i][c] = NULL; }
   text_layer_destroy(s_ghost_layers[i][c]);
       text_layer_destroy(s_digit_layers[i][c]);
     }
   }
+  if (s_ghost_hatch_layer) { layer_destroy(s_ghost_hatch_layer); s_ghost_hatch_layer = NULL; }
   if (s_bg_trend_layer) { layer_destroy(s_bg_trend_layer); s_bg_trend_layer = NULL; }
   if (s_weather_deg_layer) { layer_destroy(s_weather_deg_layer); s_weather_deg_layer = NULL; }
 }
@@ -898,39 +1595,26 @@ static void init_defaults(void) {
 }
 
 
-static void init(void) {
-  // Nur Defaults setzen, wenn keine persistierte Konfiguration existiert
-  if (!persist_exists(PERSIST_CONFIG_KEY)) {
-    init_defaults();
-  } else {
-    load_config_cache();
-  }
-
-  // Load fonts before creating/pushing window so layers can use them in load()
-  s_font_dseg_30 = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_30_BOLD));
-  s_font_dseg_30_reg = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_30_REG));
-  // Smaller variants for round to fit tighter rows
+// Everything not needed for the first frame: ghosts, services, messaging, phone requests
+static void deferred_init(void *context) {
+  s_deferred_timer = NULL;
+  profile_mark("deferred");
 #if defined(PBL_ROUND)
-  s_font_dseg_26 = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_26_BOLD));
-  s_font_dseg_26_reg = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_26_REG));
-  s_font_dseg_25 = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_25_BOLD));
   s_font_dseg_25_reg = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_25_REG));
-  s_font_dseg_29 = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_29_BOLD));
   s_font_dseg_29_reg = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_29_REG));
+#else
+  s_font_dseg_30_reg = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_30_REG));
 #endif
-  s_font_system_30 = fonts_get_system_font(FONT_KEY_BITHAM_30_BLACK);
+  style_ghost_layers();
+  create_hatch_layer();
+  profile_mark("ghosts");
 
-  s_main_window = window_create();
-  window_set_background_color(s_main_window, GColorBlack);
-  window_set_window_handlers(s_main_window, (WindowHandlers) {
-    .load = main_window_load,
-    .appear = main_window_appear,
-    .unload = main_window_unload
-  });
-  window_stack_push(s_main_window, true);
+#if defined(TELEMETRY)
+  s_telemetry = data_logging_create(TELEMETRY_TAG, DATA_LOGGING_BYTE_ARRAY, sizeof(TelemetryRecord), true);
+#endif
 
   // Services
-  tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
+  update_tick_subscription();
   battery_state_service_subscribe(battery_handler);
   health_service_events_subscribe(health_handler, NULL);
 #if PBL_API_EXISTS(unobstructed_area_service_subscribe)
@@ -940,6 +1624,12 @@ static void init(void) {
   }, NULL);
 #endif
   app_focus_service_subscribe(app_focus_handler);
+  accel_tap_service_subscribe(accel_tap_handler);
+  connection_service_subscribe((ConnectionHandlers) {
+    .pebble_app_connection_handler = app_connection_handler
+  });
+  s_connected = connection_service_peek_pebble_app_connection();
+  if (!s_connected) s_disconnected_at = time(NULL);
 
   // Messaging
   app_message_register_inbox_received(inbox_received_callback);
@@ -947,12 +1637,53 @@ static void init(void) {
   app_message_register_outbox_failed(outbox_failed_callback);
   app_message_register_outbox_sent(outbox_sent_callback);
   app_message_open(1024, 256);
+  profile_mark("services");
 
-  update_heart_rate();
+  send_hello();
+  // Catches a minute change between the first frame and the tick subscription
   update_time();
+  profile_mark("ready");
+}
+
+// Fast start: cached config and data, the digit fonts and the window; the first frame
+// is drawn from the caches before any service or phone traffic is set up
+static void init(void) {
+  profile_mark("init");
+  load_config_cache(); // falls back to init_defaults()
+  load_weather_cache();
+  load_bg_cache();
+  load_alert_state();
+  for (int i = 0; i < BG_MAX_PERSONS - 1; i++) {
+    s_bg_follow[i] = (BgPerson) { .sgv = -1, .status = BG_STATUS_NO_DATA, .trend = BG_TREND_NONE };
+  }
+  s_last_flick = time(NULL);
+  profile_mark("caches");
+
+  // Digit fonts before the window so the first draw can use them
+#if defined(PBL_ROUND)
+  // Smaller variants for round to fit tighter rows
+  s_font_dseg_25 = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_25_BOLD));
+  s_font_dseg_29 = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_29_BOLD));
+#else
+  s_font_dseg_30 = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DSEG_30_BOLD));
+#endif
+  profile_mark("fonts");
+
+  s_main_window = window_create();
+  window_set_background_color(s_main_window, GColorBlack);
+  window_set_window_handlers(s_main_window, (WindowHandlers) {
+    .load = main_window_load,
+    .appear = main_window_appear,
+    .unload = main_window_unload
+  });
+  window_stack_push(s_main_window, false);
+  profile_mark("window");
+
+  s_deferred_timer = app_timer_register(STARTUP_DEFER_MS, deferred_init, NULL);
 }
 
 static void deinit(void) {
+  if (s_deferred_timer) app_timer_cancel(s_deferred_timer);
   tick_timer_service_unsubscribe();
   battery_state_service_unsubscribe();
   health_service_events_unsubscribe();
@@ -960,11 +1691,14 @@ static void deinit(void) {
   unobstructed_area_service_unsubscribe();
 #endif
   app_focus_service_unsubscribe();
+  accel_tap_service_unsubscribe();
+  connection_service_unsubscribe();
+#if defined(TELEMETRY)
+  if (s_telemetry) data_logging_finish(s_telemetry);
+#endif
 
-  fonts_unload_custom_font(s_font_dseg_30);
+  if (s_font_dseg_30) fonts_unload_custom_font(s_font_dseg_30);
   if (s_font_dseg_30_reg) fonts_unload_custom_font(s_font_dseg_30_reg);
-  if (s_font_dseg_26) fonts_unload_custom_font(s_font_dseg_26);
-  if (s_font_dseg_26_reg) fonts_unload_custom_font(s_font_dseg_26_reg);
   if (s_font_dseg_25) fonts_unload_custom_font(s_font_dseg_25);
   if (s_font_dseg_25_reg) fonts_unload_custom_font(s_font_dseg_25_reg);
   if (s_font_dseg_29) fonts_unload_custom_font(s_font_dseg_29);
@@ -981,27 +1715,38 @@ int main(void) {
 
 static void save_config_cache(void) {
   ConfigCache cc;
-  cc.version = 1;
+  memset(&cc, 0, sizeof(cc));
+  cc.version = 6;
   for (int i=0;i<ROWS;i++) { cc.row_types[i] = s_row_types[i]; cc.row_color_hex[i] = s_row_color_hex[i]; }
   cc.ghost_hex = s_ghost_hex;
   cc.show_leading_zero = s_show_leading_zero ? 1 : 0;
   cc.date_format = s_date_format;
   cc.weekday_lang = s_weekday_lang;
   cc.temp_unit_f = s_temp_unit_f;
+  cc.weather_interval_min = s_weather_interval_min;
   cc.bg_timeout_min = s_bg_timeout_min;
   cc.bg_low = s_bg_low;
   cc.bg_high = s_bg_high;
+  cc.bg_urgent_low = s_bg_urgent_low;
+  cc.bg_alert_snooze_min = s_bg_alert_snooze_min;
+  memcpy(cc.bg_follow_tags, s_bg_follow_tags, sizeof(cc.bg_follow_tags));
+  cc.idle_mode = s_idle_enabled ? 1 : 0;
   cc.col_low_hex = s_col_low_hex;
   cc.col_high_hex = s_col_high_hex;
   cc.col_in_hex = s_col_in_hex;
+  cc.config_hash = s_config_hash;
+  if (memcmp(&cc, &s_saved_config, sizeof(cc)) == 0) return;
   persist_write_data(PERSIST_CONFIG_KEY, &cc, sizeof(cc));
+  s_saved_config = cc;
 }
 
 static void load_config_cache(void) {
   if (!persist_exists(PERSIST_CONFIG_KEY)) { init_defaults(); return; }
   ConfigCache cc;
   if (persist_read_data(PERSIST_CONFIG_KEY, &cc, sizeof(cc)) != (int)sizeof(cc)) { init_defaults(); return; }
-  if (cc.version != 1) { init_defaults(); return; }
+  if (cc.version != 6) { init_defaults(); return; }
+  s_saved_config = cc;
+  s_config_hash = cc.config_hash;
   for (int i=0;i<ROWS;i++) { s_row_types[i] = cc.row_types[i]; s_row_color_hex[i] = cc.row_color_hex[i]; s_row_colors[i] = ColorFromHex(s_row_color_hex[i]); }
   s_ghost_hex = cc.ghost_hex; s_ghost_color = ColorFromHex(s_ghost_hex);
 #if defined(PBL_COLOR)
@@ -1018,9 +1763,15 @@ static void load_config_cache(void) {
   s_date_format = cc.date_format;
   s_weekday_lang = cc.weekday_lang;
   s_temp_unit_f = cc.temp_unit_f;
+  s_weather_interval_min = cc.weather_interval_min;
   s_bg_timeout_min = cc.bg_timeout_min;
   s_bg_low = cc.bg_low;
   s_bg_high = cc.bg_high;
+  s_bg_urgent_low = cc.bg_urgent_low;
+  s_bg_alert_snooze_min = cc.bg_alert_snooze_min;
+  memcpy(s_bg_follow_tags, cc.bg_follow_tags, sizeof(s_bg_follow_tags));
+  s_bg_follow_tags[BG_MAX_PERSONS - 1] = 0;
+  s_idle_enabled = cc.idle_mode != 0;
   s_col_low_hex = cc.col_low_hex; s_col_low = ColorFromHex(s_col_low_hex);
   s_col_high_hex = cc.col_high_hex; s_col_high = ColorFromHex(s_col_high_hex);
   s_col_in_hex = cc.col_in_hex; s_col_in = ColorFromHex(s_col_in_hex);
@@ -1040,87 +1791,142 @@ static void load_config_cache(void) {
 #endif
 }
 
-// Draw compact trend arrows without relying on glyphs; use simple triangles/lines
-static void trend_update_proc(Layer *layer, GContext *ctx) {
-  // Determine what to draw from s_bg_trend string; support '↑↑', '↑', '↗', '→', '↘', '↓', '↓↓' and ASCII fallbacks '^^','^','/>','-','\\>','v','vv'
-  const char *t = s_bg_trend;
-  GRect b = layer_get_bounds(layer);
-  graphics_context_set_stroke_color(ctx, s_bg_trend_color);
-  graphics_context_set_fill_color(ctx, s_bg_trend_color);
-  graphics_context_set_stroke_width(ctx, 2);
-  // Normalize to simple keywords
-  bool dbl_up=false, up=false, diag_up=false, flat=false, diag_down=false, down=false, dbl_down=false;
-  if (t) {
-    if (strstr(t, "↑↑")||strstr(t,"^^")) dbl_up=true;
-    else if (strstr(t, "↓↓")||strstr(t,"vv")) dbl_down=true;
-    else if (strstr(t, "↑")||strstr(t,"^")) up=true;
-    else if (strstr(t, "↓")||strstr(t,"v")) down=true;
-    else if (strstr(t, "↗")||strstr(t, "/>")||strstr(t, "/>")) diag_up=true;
-    else if (strstr(t, "↘")||strstr(t, "\\>")) diag_down=true;
-    else flat=true;
-  }
-  if (!t || t[0]==0) flat = true;
-
-  // Draw center arrow(s)
+static void save_weather_cache(void) {
+  WeatherCache wc;
+  wc.version = 1;
+  wc.data = s_weather;
+  persist_write_data(PERSIST_WEATHER_KEY, &wc, sizeof(wc));
+}
+
+static void load_weather_cache(void) {
+  if (!persist_exists(PERSIST_WEATHER_KEY)) return;
+  WeatherCache wc;
+  if (persist_read_data(PERSIST_WEATHER_KEY, &wc, sizeof(wc)) != (int)sizeof(wc)) return;
+  if (wc.version != 1) return;
+  s_weather = wc.data;
+}
+
+static void save_bg_cache(void) {
+  BgCache bc;
+  memset(&bc, 0, sizeof(bc));
+  bc.version = 1;
+  bc.sgv = s_bg_sgv;
+  bc.status = s_bg_status;
+  bc.trend = s_bg_trend;
+  bc.timestamp = s_bg_timestamp;
+  bc.unit_mmol = s_bg_unit_mmol;
+  bc.extras = s_bg_extras;
+  if (memcmp(&bc, &s_saved_bg, sizeof(bc)) == 0) return;
+  persist_write_data(PERSIST_BG_KEY, &bc, sizeof(bc));
+  s_saved_bg = bc;
+}
+
+static void load_bg_cache(void) {
+  if (!persist_exists(PERSIST_BG_KEY)) return;
+  BgCache bc;
+  if (persist_read_data(PERSIST_BG_KEY, &bc, sizeof(bc)) != (int)sizeof(bc)) return;
+  if (bc.version != 1) return;
+  s_saved_bg = bc;
+  s_bg_sgv = bc.sgv;
+  s_bg_status = bc.status;
+  s_bg_trend = bc.trend < BG_TREND_COUNT ? bc.trend : BG_TREND_NONE;
+  s_bg_timestamp = bc.timestamp;
+  s_bg_unit_mmol = bc.unit_mmol ? 1 : 0;
+  s_bg_extras = bc.extras;
+}
+
+// Trend arrows are plain line sets, built once per trend layer size and replayed on paint
+#define TREND_MAX_SEGMENTS 6
+typedef struct {
+  GPoint a, b;
+} TrendSegment;
+typedef struct {
+  uint8_t count;
+  TrendSegment seg[TREND_MAX_SEGMENTS];
+} TrendShape;
+// One shape per trend, plus a cross drawn instead of the arrow while the phone is unreachable
+#define TREND_SHAPE_NO_BT BG_TREND_COUNT
+static TrendShape s_trend_shapes[BG_TREND_COUNT + 1];
+static GSize s_trend_shape_size;
+
+static void trend_shape_add(int trend, GPoint a, GPoint b) {
+  TrendShape *shape = &s_trend_shapes[trend];
+  if (shape->count >= TREND_MAX_SEGMENTS) return;
+  shape->seg[shape->count].a = a;
+  shape->seg[shape->count].b = b;
+  shape->count++;
+}
+
+static void build_trend_shapes(GRect b) {
+  memset(s_trend_shapes, 0, sizeof(s_trend_shapes));
   int cx = b.origin.x + b.size.w/2;
   int cy = b.origin.y + b.size.h/2;
   int len = b.size.h/3;
-  // helpers
+  int off = 8; // spacing of the second arrow in double variants
   GPoint upA = GPoint(cx, cy+len/2), upB = GPoint(cx, cy-len/2);
   GPoint upL = GPoint(cx-4, cy-len/2+6), upR = GPoint(cx+4, cy-len/2+6);
   GPoint dnA = GPoint(cx, cy-len/2), dnB = GPoint(cx, cy+len/2);
   GPoint dnL = GPoint(cx-4, cy+len/2-6), dnR = GPoint(cx+4, cy+len/2-6);
-  if (flat) {
-    graphics_draw_line(ctx, GPoint(b.origin.x+4, cy), GPoint(b.origin.x+b.size.w-4, cy));
-    return;
-  }
-  if (up||dbl_up) {
-    graphics_draw_line(ctx, upA, upB);
-    graphics_draw_line(ctx, upB, upL);
-    graphics_draw_line(ctx, upB, upR);
-    if (dbl_up) {
-      int off = 8;
-      GPoint a = GPoint(upA.x+off, upA.y);
-      GPoint b2= GPoint(upB.x+off, upB.y);
-      GPoint l = GPoint(upL.x+off, upL.y);
-      GPoint r = GPoint(upR.x+off, upR.y);
-      graphics_draw_line(ctx, a, b2);
-      graphics_draw_line(ctx, b2, l);
-      graphics_draw_line(ctx, b2, r);
+
+  for (int k = 0; k < 2; k++) {
+    int dx = k * off;
+    if (k == 0) {
+      trend_shape_add(BG_TREND_SINGLE_UP, upA, upB);
+      trend_shape_add(BG_TREND_SINGLE_UP, upB, upL);
+      trend_shape_add(BG_TREND_SINGLE_UP, upB, upR);
+      trend_shape_add(BG_TREND_SINGLE_DOWN, dnA, dnB);
+      trend_shape_add(BG_TREND_SINGLE_DOWN, dnB, dnL);
+      trend_shape_add(BG_TREND_SINGLE_DOWN, dnB, dnR);
     }
-    return;
+    trend_shape_add(BG_TREND_DOUBLE_UP, GPoint(upA.x+dx, upA.y), GPoint(upB.x+dx, upB.y));
+    trend_shape_add(BG_TREND_DOUBLE_UP, GPoint(upB.x+dx, upB.y), GPoint(upL.x+dx, upL.y));
+    trend_shape_add(BG_TREND_DOUBLE_UP, GPoint(upB.x+dx, upB.y), GPoint(upR.x+dx, upR.y));
+    trend_shape_add(BG_TREND_DOUBLE_DOWN, GPoint(dnA.x+dx, dnA.y), GPoint(dnB.x+dx, dnB.y));
+    trend_shape_add(BG_TREND_DOUBLE_DOWN, GPoint(dnB.x+dx, dnB.y), GPoint(dnL.x+dx, dnL.y));
+    trend_shape_add(BG_TREND_DOUBLE_DOWN, GPoint(dnB.x+dx, dnB.y), GPoint(dnR.x+dx, dnR.y));
   }
-  if (down||dbl_down) {
-    graphics_draw_line(ctx, dnA, dnB);
-    graphics_draw_line(ctx, dnB, dnL);
-    graphics_draw_line(ctx, dnB, dnR);
-    if (dbl_down) {
-      int off = 8;
-      GPoint a = GPoint(dnA.x+off, dnA.y);
-      GPoint b2= GPoint(dnB.x+off, dnB.y);
-      GPoint l = GPoint(dnL.x+off, dnL.y);
-      GPoint r = GPoint(dnR.x+off, dnR.y);
-      graphics_draw_line(ctx, a, b2);
-      graphics_draw_line(ctx, b2, l);
-      graphics_draw_line(ctx, b2, r);
-    }
-    return;
+
+  GPoint tip = GPoint(cx+len/2, cy-len/2);
+  trend_shape_add(BG_TREND_FORTY_FIVE_UP, GPoint(cx-len/2, cy+len/2), tip);
+  trend_shape_add(BG_TREND_FORTY_FIVE_UP, tip, GPoint(tip.x-6, tip.y+2));
+  trend_shape_add(BG_TREND_FORTY_FIVE_UP, tip, GPoint(tip.x-2, tip.y+6));
+  tip = GPoint(cx+len/2, cy+len/2);
+  trend_shape_add(BG_TREND_FORTY_FIVE_DOWN, GPoint(cx-len/2, cy-len/2), tip);
+  trend_shape_add(BG_TREND_FORTY_FIVE_DOWN, tip, GPoint(tip.x-6, tip.y-2));
+  trend_shape_add(BG_TREND_FORTY_FIVE_DOWN, tip, GPoint(tip.x-2, tip.y-6));
+
+  int x0 = b.origin.x + 4;
+  int x1 = b.origin.x + b.size.w - 4;
+  trend_shape_add(BG_TREND_FLAT, GPoint(x0, cy), GPoint(x1, cy));
+  // Not computable: dashed flat line
+  int dash = (x1 - x0) / 3;
+  for (int d = 0; d < 3; d++) {
+    trend_shape_add(BG_TREND_NOT_COMPUTABLE, GPoint(x0 + d*dash + 1, cy), GPoint(x0 + (d+1)*dash - 2, cy));
   }
-  if (diag_up) {
-    GPoint a = GPoint(cx-len/2, cy+len/2);
-    GPoint b3= GPoint(cx+len/2, cy-len/2);
-    graphics_draw_line(ctx, a, b3);
-    graphics_draw_line(ctx, b3, GPoint(b3.x-6, b3.y+2));
-    graphics_draw_line(ctx, b3, GPoint(b3.x-2, b3.y+6));
-    return;
+  // Rate out of range: vertical line with heads at both ends
+  trend_shape_add(BG_TREND_RATE_OUT_OF_RANGE, upA, upB);
+  trend_shape_add(BG_TREND_RATE_OUT_OF_RANGE, upB, upL);
+  trend_shape_add(BG_TREND_RATE_OUT_OF_RANGE, upB, upR);
+  trend_shape_add(BG_TREND_RATE_OUT_OF_RANGE, dnB, dnL);
+  trend_shape_add(BG_TREND_RATE_OUT_OF_RANGE, dnB, dnR);
+  trend_shape_add(TREND_SHAPE_NO_BT, GPoint(cx-len/2, cy-len/2), GPoint(cx+len/2, cy+len/2));
+  trend_shape_add(TREND_SHAPE_NO_BT, GPoint(cx-len/2, cy+len/2), GPoint(cx+len/2, cy-len/2));
+
+  s_trend_shape_size = b.size;
+}
+
+static void trend_update_proc(Layer *layer, GContext *ctx) {
+  GRect b = layer_get_bounds(layer);
+  if (b.size.w != s_trend_shape_size.w || b.size.h != s_trend_shape_size.h) {
+    build_trend_shapes(b);
   }
-  if (diag_down) {
-    GPoint a = GPoint(cx-len/2, cy-len/2);
-    GPoint b3= GPoint(cx+len/2, cy+len/2);
-    graphics_draw_line(ctx, a, b3);
-    graphics_draw_line(ctx, b3, GPoint(b3.x-6, b3.y-2));
-    graphics_draw_line(ctx, b3, GPoint(b3.x-2, b3.y-6));
-    return;
+  int index = s_connected ? (int)s_bg_trend : TREND_SHAPE_NO_BT;
+  if (index <= BG_TREND_NONE || index > TREND_SHAPE_NO_BT) return;
+  graphics_context_set_stroke_color(ctx, s_bg_trend_color);
+  graphics_context_set_stroke_width(ctx, 2);
+  const TrendShape *shape = &s_trend_shapes[index];
+  for (int i = 0; i < shape->count; i++) {
+    graphics_draw_line(ctx, shape->seg[i].a, shape->seg[i].b);
   }
 }
 
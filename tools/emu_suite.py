@@ -0,0 +1,344 @@
+#!/usr/bin/env python
+"""Emulator regression suite: renders a set of row-type/config scenarios on every
+platform, compares screenshots against reference PNGs and collects the `prof` timings.
+
+Per platform: install the profile build, start `pebble logs`, and for each scenario
+set a fixed emulator time, inject the scenario's AppMessages (as the phone would send
+them, through the emulator's pypkjs websocket), take `pebble screenshot` and diff it
+against tools/emu_ref/<platform>/<scenario>.png. Timings from the `prof` log lines go
+to build/emu_report.json. The build leaves out the companion JS (SUPERCGM_NO_JS=1), so
+its own polling cannot overwrite a scenario between injection and screenshot.
+
+    python tools/emu_suite.py                  # build, run, compare
+    python tools/emu_suite.py --record         # store the screenshots as the references
+    python tools/emu_suite.py --platforms chalk --scenarios seconds --no-build
+
+Run --record once to create tools/emu_ref/ and again after an intended visual change,
+look through the new PNGs and commit them; without a reference a scenario fails.
+
+Needs the Pebble SDK tool (`pebble`) plus the libpebble2 and pypng packages it ships with.
+"""
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import uuid
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+REF_DIR = os.path.join(ROOT, 'tools', 'emu_ref')
+OUT_DIR = os.path.join(ROOT, 'build', 'emu_suite')
+PLATFORMS = ['aplite', 'basalt', 'chalk', 'diorite']
+
+# Fixed watch time for every screenshot: Thu 2024-03-14 10:09:30 UTC
+FIXED_TIME = 1710410970
+SETTLE_S = 8      # after install: the first frame and deferred init are done by then
+RENDER_S = 1.5    # after injecting a scenario, before the screenshot
+TOLERANCE = 0.002  # fraction of pixels allowed to differ
+
+# Enum values from src/main.c
+ROW = {'TIME': 0, 'DATE': 1, 'WEEKDAY': 2, 'WEATHER': 3, 'BATTERY': 4, 'BG': 5, 'STEPS': 6,
+       'HEART_RATE': 7, 'SECONDS': 8, 'MIN_SEC': 9, 'BG_PERSON2': 10, 'BG_PERSON3': 11,
+       'BG_DELTA': 12, 'IOB': 13, 'COB': 14, 'BG_RAW': 15}
+TREND = {'NONE': 0, 'DOUBLE_UP': 1, 'SINGLE_UP': 2, 'FORTY_FIVE_UP': 3, 'FLAT': 4,
+         'FORTY_FIVE_DOWN': 5, 'SINGLE_DOWN': 6, 'DOUBLE_DOWN': 7, 'NOT_COMPUTABLE': 8,
+         'RATE_OUT_OF_RANGE': 9}
+BG_OK, BG_NO_DATA = 0, 1
+EXTRA_UNKNOWN = -32768
+
+
+def int16le(*values):
+    out = []
+    for v in values:
+        v &= 0xFFFF
+        out += [v & 0xFF, v >> 8]
+    return out
+
+
+def follower(slot, sgv, trend, ts):
+    return [slot, BG_OK, trend] + int16le(sgv) + [ts & 0xFF, (ts >> 8) & 0xFF, (ts >> 16) & 0xFF, (ts >> 24) & 0xFF]
+
+
+def bg(sgv, trend='FLAT', age_min=1, mmol=False):
+    return {'BG_STATUS': BG_OK, 'BG_SGV': sgv, 'BG_TIMESTAMP': FIXED_TIME - age_min * 60,
+            'BG_TREND': TREND[trend], 'BG_UNIT': 1 if mmol else 0}
+
+
+# Each scenario is one config message (rows, then data); rows beyond the fourth are not
+# shown on chalk. 'tolerance' overrides TOLERANCE where the face may tick during capture.
+# 'then' runs emulator steps after the message and before the screenshot: ('time', s)
+# sets the watch to FIXED_TIME + s, ('bt', False) drops the phone connection. 'restore'
+# runs after the screenshot.
+SCENARIOS = [
+    ('default', {'rows': ['TIME', 'DATE', 'WEEKDAY', 'BATTERY', 'BG'], 'data': bg(120)}),
+    ('bg_low_weather', {'rows': ['WEATHER', 'TIME', 'STEPS', 'HEART_RATE', 'BG'],
+                        'data': dict(bg(62, 'SINGLE_DOWN'), TEMP_UNIT=0, WEATHER_TEMP=12,
+                                     WEATHER_TIMESTAMP=FIXED_TIME - 300, WEATHER_CODE=3)}),
+    ('bg_high_mmol', {'rows': ['BG', 'TIME', 'DATE', 'BG_DELTA', 'IOB'],
+                      'data': dict(bg(250, 'DOUBLE_UP', mmol=True),
+                                   BG_EXTRAS=int16le(14, 23, EXTRA_UNKNOWN, EXTRA_UNKNOWN))}),
+    ('extras', {'rows': ['BG_DELTA', 'IOB', 'COB', 'BG_RAW', 'BG'],
+                'data': dict(bg(142, 'FORTY_FIVE_UP'), BG_EXTRAS=int16le(-3, 12, 25, 138))}),
+    ('followers', {'rows': ['BG_PERSON2', 'TIME', 'BG', 'BG_PERSON3', 'DATE'],
+                   'data': dict(bg(101), BG_FOLLOW=follower(0, 142, TREND['FLAT'], FIXED_TIME - 120) +
+                                follower(1, 55, TREND['SINGLE_DOWN'], FIXED_TIME - 120))}),
+    ('stale_bg', {'rows': ['TIME', 'DATE', 'BG', 'BATTERY', 'WEEKDAY'], 'data': bg(120, age_min=45)}),
+    ('no_bg', {'rows': ['TIME', 'BG', 'DATE', 'BATTERY', 'WEEKDAY'],
+               'data': {'BG_STATUS': BG_NO_DATA, 'BG_SGV': -1}}),
+    ('seconds', {'rows': ['MIN_SEC', 'TIME', 'SECONDS', 'DATE', 'MIN_SEC'], 'data': bg(120),
+                 'tolerance': 0.02}),
+    ('trend_not_computable', {'rows': ['TIME', 'DATE', 'BG', 'BATTERY', 'WEEKDAY'],
+                              'data': bg(120, 'NOT_COMPUTABLE')}),
+    ('trend_out_of_range', {'rows': ['TIME', 'DATE', 'BG', 'BATTERY', 'WEEKDAY'],
+                            'data': bg(320, 'RATE_OUT_OF_RANGE')}),
+    # Idle starts on the first minute tick 5 min after the message (no wrist flick)
+    ('idle', {'rows': ['TIME', 'SECONDS', 'STEPS', 'HEART_RATE', 'BG'], 'data': dict(bg(120), IDLE_MODE=1),
+              'then': [('time', 5 * 60 + 28), ('wait', 3)]}),
+    # Stale reading and no phone: NO-BT with the crossed trend
+    ('disconnected', {'rows': ['TIME', 'DATE', 'BG', 'BATTERY', 'WEEKDAY'], 'data': bg(120, age_min=45),
+                      'then': [('bt', False)], 'restore': [('bt', True)]}),
+]
+
+PROF_RE = {
+    'startup': re.compile(r'prof startup (\S+) \+(-?\d+) ms'),
+    'draw': re.compile(r'prof draw (-?\d+) ms'),
+    'frame': re.compile(r'prof frame \d+ (-?\d+) ms'),
+    'seconds': re.compile(r'prof seconds (\d+) ticks, update (-?\d+) ms, render (-?\d+) ms'),
+}
+
+
+def message_keys():
+    """Key ids as the SDK assigns them: package.json order from 10000, KEY[n] takes n ids."""
+    with open(os.path.join(ROOT, 'package.json')) as f:
+        pebble = json.load(f)['pebble']
+    keys, next_id = {}, 10000
+    for entry in pebble['messageKeys']:
+        m = re.match(r'(\w+)(?:\[(\d+)\])?$', entry)
+        keys[m.group(1)] = next_id
+        next_id += int(m.group(2) or 1)
+    return keys, uuid.UUID(pebble['uuid'])
+
+
+def pebble(*args, **kwargs):
+    cmd = ['pebble'] + list(args)
+    print('$ ' + ' '.join(cmd))
+    subprocess.check_call(cmd, cwd=ROOT, **kwargs)
+
+
+def emulator_pypkjs_port(platform):
+    with open(os.path.join(tempfile.gettempdir(), 'pb-emulator.json')) as f:
+        info = json.load(f)
+    for version in info.get(platform, {}).values():
+        if 'pypkjs' in version:
+            return version['pypkjs']['port']
+    raise RuntimeError('no running {} emulator in pb-emulator.json'.format(platform))
+
+
+class Injector(object):
+    """Sends AppMessages to the watchface the way the companion would."""
+
+    def __init__(self, platform, keys, app_uuid):
+        from libpebble2.communication import PebbleConnection
+        from libpebble2.communication.transports.websocket import WebsocketTransport
+        from libpebble2.services.appmessage import AppMessageService
+        self.keys, self.app_uuid = keys, app_uuid
+        self.conn = PebbleConnection(WebsocketTransport('ws://localhost:{}/'.format(emulator_pypkjs_port(platform))))
+        self.conn.connect()
+        self.conn.run_async()
+        self.service = AppMessageService(self.conn)
+
+    def send(self, values):
+        from libpebble2.services.appmessage import ByteArray, Int32
+        msg = {}
+        for name, value in values.items():
+            msg[self.keys[name]] = ByteArray(bytearray(value)) if isinstance(value, list) else Int32(value)
+        self.service.send_message(self.app_uuid, msg)
+
+    def close(self):
+        self.service.shutdown()
+        try:
+            self.conn.transport.ws.close()
+        except Exception:
+            pass
+
+
+def scenario_message(scenario):
+    values = {'ROW{}_TYPE'.format(i + 1): ROW[r] for i, r in enumerate(scenario['rows'])}
+    values.update({'ROW{}_COLOR'.format(i + 1): 0xFFFFFF for i in range(len(scenario['rows']))})
+    values['IDLE_MODE'] = 0  # leaves idle from an earlier scenario
+    values.update(scenario['data'])
+    return values
+
+
+def emulator_steps(platform, steps):
+    for step, value in steps:
+        if step == 'time':
+            pebble('emu-set-time', '--emulator', platform, str(FIXED_TIME + value))
+        elif step == 'bt':
+            pebble('emu-bt-connection', '--emulator', platform, '--connected', 'yes' if value else 'no')
+        time.sleep(value if step == 'wait' else RENDER_S)
+
+
+def read_png(path):
+    import png
+    width, height, rows, _info = png.Reader(filename=path).asRGBA8()
+    return width, height, [bytearray(r) for r in rows]
+
+
+def diff_fraction(actual, reference, diff_path):
+    """Fraction of differing pixels; writes a mask (differences in red) next to the shot."""
+    import png
+    aw, ah, a = read_png(actual)
+    rw, rh, r = read_png(reference)
+    if (aw, ah) != (rw, rh):
+        return 1.0
+    differing, mask = 0, []
+    for ra, rr in zip(a, r):
+        row = bytearray()
+        for x in range(0, len(ra), 4):
+            same = ra[x:x + 3] == rr[x:x + 3]
+            differing += not same
+            row += bytearray([64, 64, 64]) if same else bytearray([255, 0, 0])
+        mask.append(row)
+    with open(diff_path, 'wb') as f:
+        png.Writer(aw, ah, greyscale=False).write(f, mask)
+    return differing / float(aw * ah)
+
+
+class LogTail(object):
+    """Collects `prof` lines from `pebble logs` in the background."""
+
+    def __init__(self, platform):
+        self.lines = []
+        self.proc = subprocess.Popen(['pebble', 'logs', '--emulator', platform], cwd=ROOT,
+                                     stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        self.thread = threading.Thread(target=self._read)
+        self.thread.daemon = True
+        self.thread.start()
+
+    def _read(self):
+        for line in iter(self.proc.stdout.readline, ''):
+            if 'prof ' in line:
+                self.lines.append(line.strip())
+
+    def mark(self):
+        return len(self.lines)
+
+    def stop(self):
+        self.proc.terminate()
+        self.proc.wait()
+
+
+def timings(lines):
+    out = {'startup': {}, 'draw_ms': [], 'frame_ms': [], 'seconds': []}
+    for line in lines:
+        m = PROF_RE['startup'].search(line)
+        if m:
+            out['startup'][m.group(1)] = int(m.group(2))
+        m = PROF_RE['draw'].search(line)
+        if m:
+            out['draw_ms'].append(int(m.group(1)))
+        m = PROF_RE['frame'].search(line)
+        if m:
+            out['frame_ms'].append(int(m.group(1)))
+        m = PROF_RE['seconds'].search(line)
+        if m:
+            out['seconds'].append({'ticks': int(m.group(1)), 'update_ms': int(m.group(2)), 'render_ms': int(m.group(3))})
+    for key in ('draw_ms', 'frame_ms'):
+        values = sorted(out[key])
+        out[key.replace('_ms', '_summary')] = {
+            'count': len(values),
+            'median': values[len(values) // 2] if values else None,
+            'max': values[-1] if values else None,
+        }
+    return out
+
+
+def run_platform(platform, scenarios, keys, app_uuid, record):
+    shots_dir = os.path.join(OUT_DIR, platform)
+    if not os.path.isdir(shots_dir):
+        os.makedirs(shots_dir)
+    pebble('install', '--emulator', platform)
+    logs = LogTail(platform)
+    time.sleep(SETTLE_S)
+    report = {'scenarios': {}, 'launch': None}
+    failures = []
+    injector = Injector(platform, keys, app_uuid)
+    try:
+        report['launch'] = timings(logs.lines[:logs.mark()])
+        for name, scenario in scenarios:
+            start = logs.mark()
+            pebble('emu-set-time', '--emulator', platform, str(FIXED_TIME))
+            injector.send(scenario_message(scenario))
+            time.sleep(RENDER_S)
+            emulator_steps(platform, scenario.get('then', []))
+            shot = os.path.join(shots_dir, name + '.png')
+            pebble('screenshot', '--emulator', platform, '--no-open', shot)
+            emulator_steps(platform, scenario.get('restore', []))
+            entry = timings(logs.lines[start:logs.mark()])
+            ref = os.path.join(REF_DIR, platform, name + '.png')
+            if record:
+                if not os.path.isdir(os.path.dirname(ref)):
+                    os.makedirs(os.path.dirname(ref))
+                with open(shot, 'rb') as src, open(ref, 'wb') as dst:
+                    dst.write(src.read())
+                entry['screenshot'] = 'recorded'
+            elif not os.path.exists(ref):
+                entry['screenshot'] = 'no reference'
+                failures.append('{}/{}: no reference, record one with --record'.format(platform, name))
+            else:
+                fraction = diff_fraction(shot, ref, os.path.join(shots_dir, name + '.diff.png'))
+                allowed = scenario.get('tolerance', TOLERANCE)
+                entry['screenshot'] = {'differing': round(fraction, 5), 'allowed': allowed}
+                if fraction > allowed:
+                    failures.append('{}/{}: {:.2%} of pixels differ (allowed {:.2%}), see {}'.format(
+                        platform, name, fraction, allowed, os.path.join(shots_dir, name + '.diff.png')))
+            report['scenarios'][name] = entry
+            print('[emu] {:8s} {:16s} screenshot={} draw~{} ms frame~{} ms'.format(
+                platform, name, entry['screenshot'] if isinstance(entry['screenshot'], str)
+                else '{:.2%}'.format(entry['screenshot']['differing']),
+                entry['draw_summary']['median'], entry['frame_summary']['median']))
+    finally:
+        injector.close()
+        logs.stop()
+    return report, failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--platforms', nargs='+', default=PLATFORMS, choices=PLATFORMS)
+    parser.add_argument('--scenarios', nargs='+', help='subset of: ' + ', '.join(n for n, _ in SCENARIOS))
+    parser.add_argument('--record', action='store_true', help='store the screenshots as the references')
+    parser.add_argument('--no-build', action='store_true',
+                        help='use the existing build (must have SUPERCGM_PROFILE=1 SUPERCGM_NO_JS=1)')
+    args = parser.parse_args()
+
+    scenarios = [(n, s) for n, s in SCENARIOS if not args.scenarios or n in args.scenarios]
+    if not args.no_build:
+        env = dict(os.environ, SUPERCGM_PROFILE='1', SUPERCGM_NO_JS='1')
+        pebble('build', env=env)
+    keys, app_uuid = message_keys()
+
+    report, failures = {}, []
+    for platform in args.platforms:
+        report[platform], platform_failures = run_platform(platform, scenarios, keys, app_uuid, args.record)
+        failures += platform_failures
+
+    if not os.path.isdir(OUT_DIR):
+        os.makedirs(OUT_DIR)
+    with open(os.path.join(ROOT, 'build', 'emu_report.json'), 'w') as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+    print('[emu] timings and diff results in build/emu_report.json')
+    for msg in failures:
+        print('[emu] FAIL ' + msg)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,49 @@
+// Stand-in Nightscout: GET /pebble plus a socket.io (EIO=4) websocket that pushes dataUpdate
+var http = require('http'), crypto = require('crypto');
+module.exports = function(port, state) {
+  var sockets = [];
+  var srv = http.createServer(function(req, res){
+    state.httpCount = (state.httpCount || 0) + 1;
+    var r = state.reading;
+    res.setHeader('content-type', 'application/json');
+    res.end(JSON.stringify({ bgs: [{ sgv: String(r.mgdl), datetime: r.mills, direction: r.direction, bgdelta: 0 }] }));
+  });
+  function frame(str) {
+    var b = Buffer.from(str), h;
+    if (b.length < 126) { h = Buffer.from([0x81, b.length]); }
+    else { h = Buffer.alloc(4); h[0] = 0x81; h[1] = 126; h.writeUInt16BE(b.length, 2); }
+    return Buffer.concat([h, b]);
+  }
+  function parse(buf) {
+    var len = buf[1] & 0x7f, off = 2; if (len === 126) { len = buf.readUInt16BE(2); off = 4; }
+    var mask = buf.slice(off, off + 4); off += 4;
+    var out = Buffer.alloc(len); for (var i = 0; i < len; i++) out[i] = buf[off + i] ^ mask[i % 4];
+    return { op: buf[0] & 0x0f, text: out.toString() };
+  }
+  srv.on('upgrade', function(req, sock){
+    if (state.refuse) { sock.destroy(); return; }
+    var accept = crypto.createHash('sha1').update(req.headers['sec-websocket-key'] + '258EAFA5-E914-47DA-95CA-C5AB0DC85B11').digest('base64');
+    sock.write('HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ' + accept + '\r\n\r\n');
+    sock.write(frame('0{"sid":"x","pingInterval":25000,"pingTimeout":20000}'));
+    sock.on('data', function(d){
+      var m = parse(d); if (m.op === 8) { sock.end(); return; }
+      if (m.text === '40') sock.write(frame('40{"sid":"y"}'));
+      if (m.text.indexOf('42["authorize"') === 0 || m.text.indexOf('420["authorize"') === 0) {
+        state.authorized = (state.authorized || 0) + 1;
+        var id = m.text.charAt(2) === '0' ? '0' : null;
+        if (state.auth === 'deny') { if (id) sock.write(frame('43' + id + JSON.stringify([{ read: false }]))); }
+        else if (state.auth !== 'none') { sock.authed = true; if (id) sock.write(frame('43' + id + JSON.stringify([{ read: true, write: false }]))); }
+      }
+    });
+    sock.on('error', function(){});
+    sock.on('close', function(){ sockets = sockets.filter(function(s){ return s !== sock; }); });
+    sockets.push(sock);
+  });
+  srv.listen(port);
+  return {
+    server: srv,
+    push: function(r){ state.reading = r; sockets.forEach(function(s){ if (s.authed) s.write(frame('42' + JSON.stringify(['dataUpdate', { delta: true, sgvs: [r] }]))); }); },
+    dropAll: function(){ sockets.forEach(function(s){ s.destroy(); }); sockets = []; },
+    count: function(){ return sockets.length; }
+  };
+};
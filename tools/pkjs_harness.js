@@ -0,0 +1,41 @@
+// Minimal PebbleKit JS environment for running src/js/pebble-js-app.js under node.
+// Pebble.sendAppMessage records each message by key name (and calls opts.onSend if given),
+// localStorage is backed by opts.storage, XMLHttpRequest and geolocation are recorded stubs.
+var fs = require('fs'), path = require('path'), vm = require('vm');
+var ROOT = path.join(__dirname, '..');
+module.exports = function(opts) {
+  opts = opts || {};
+  var pkg = JSON.parse(fs.readFileSync(path.join(ROOT, 'package.json')));
+  var keys = {}; pkg.pebble.messageKeys.forEach(function(k,i){ keys[k.split('[')[0]] = 10000+i; });
+  var store = opts.storage || {};
+  var listeners = {};
+  var sent = [], xhrs = [], geo = [];
+  function XHR(){ this.timeout = 0; }
+  XHR.prototype.open = function(m,u){ this.url = u; };
+  XHR.prototype.send = function(){ xhrs.push(this); if (opts.onXhr) opts.onXhr(this); };
+  XHR.prototype.setRequestHeader = function(){};
+  var ctx = {
+    console: opts.quiet ? { log: function(){} } : console,
+    require: function(n){ if (n === 'message_keys') return keys; throw new Error(n); },
+    localStorage: { getItem: function(k){ return k in store ? store[k] : null; }, setItem: function(k,v){ store[k] = String(v); }, removeItem: function(k){ delete store[k]; } },
+    XMLHttpRequest: XHR,
+    navigator: { geolocation: { getCurrentPosition: function(ok, err, o){ geo.push({ok:ok, err:err, opts:o}); if (opts.onGeo) opts.onGeo(ok, err, o); } } },
+    Pebble: {
+      addEventListener: function(n, f){ (listeners[n] = listeners[n] || []).push(f); },
+      sendAppMessage: function(d, ok, fail){ var r = {}; Object.keys(d).forEach(function(k){ var name = Object.keys(keys).filter(function(x){ return keys[x] == k; })[0]; r[name || k] = d[k]; }); sent.push(r); if (opts.onSend) opts.onSend(r, ok, fail); else if (ok) setTimeout(ok, 0); },
+      getActiveWatchInfo: function(){ return { platform: opts.platform || 'basalt' }; },
+      openURL: function(){}
+    },
+    setTimeout: opts.setTimeout || setTimeout, clearTimeout: opts.clearTimeout || clearTimeout,
+    setInterval: opts.setInterval || function(){ return 1; }, clearInterval: function(){},
+    Date: opts.Date || Date, Math: Math, JSON: JSON, parseInt: parseInt, parseFloat: parseFloat, isFinite: isFinite, encodeURIComponent: encodeURIComponent, decodeURIComponent: decodeURIComponent, String: String, Object: Object, Array: Array, Error: Error
+  };
+  if (opts.WebSocket) ctx.WebSocket = opts.WebSocket;
+  vm.createContext(ctx);
+  vm.runInContext(fs.readFileSync(opts.file || path.join(ROOT, 'src', 'js', 'pebble-js-app.js'), 'utf8'), ctx, { filename: 'pebble-js-app.js' });
+  return {
+    keys: keys, store: store, sent: sent, xhrs: xhrs, geo: geo, ctx: ctx,
+    emit: function(n, e){ (listeners[n] || []).forEach(function(f){ f(e || {}); }); },
+    respond: function(x, status, body){ x.status = status; x.responseText = typeof body === 'string' ? body : JSON.stringify(body); x.onload && x.onload.call(x); }
+  };
+};
@@ -0,0 +1,155 @@
+// Checks the companion's Nightscout stream against tools/ns_stub.js:
+//   node --experimental-websocket tools/stream_test.js [case...]
+// Each case runs in its own node process (a fresh companion) and exits non-zero on failure.
+//   push     pushed readings reach the watch at once; a dropped socket falls back to the
+//            normal poll interval and the stream reconnects
+//   deny     a denied authorize stops streaming, polling stays at the configured interval
+//   none     an unanswered authorize is dropped after the timeout, polling stays as well
+//   restart  a restarted companion does not resend its stored reading from the first
+//            dataUpdate, so the stored delta/IOB/COB/raw survive
+var childProcess = require('child_process'), http = require('http');
+var Harness = require('./pkjs_harness.js'), NightscoutStub = require('./ns_stub.js');
+
+var CASES = ['push', 'deny', 'none', 'restart'];
+var PORT = 18090;
+
+// stored: companion state store (supercgm_state) to start from, gets the test config
+function start(state, stored, timerLog) {
+  var ns = NightscoutStub(PORT, state);
+  var config = { bgUrl: 'http://127.0.0.1:' + PORT + '/?token=abc', bgStreaming: true, bgFetchIntervalMin: 5,
+    rows: [{ type: 5, color: '#FFFFFF' }], colors: {} };
+  var storage = stored ? { supercgm_state: JSON.stringify(Object.assign({ v: 1, config: config }, stored)) }
+    : { supercgm_config: JSON.stringify(config) };
+  var h = Harness({ quiet: true, WebSocket: WebSocket, setInterval: setInterval, storage: storage,
+    setTimeout: function(f, ms){ if (timerLog && ms >= 60000) timerLog.push(Math.round(ms / 60000)); return setTimeout(f, ms); },
+    onSend: function(m, ok){ if (state.onSend) state.onSend(m); if (ok) setTimeout(ok, 0); } });
+  // The /pebble poll goes to the stub over real HTTP
+  h.ctx.XMLHttpRequest = function(){};
+  h.ctx.XMLHttpRequest.prototype.open = function(m, u){ this.url = u; };
+  h.ctx.XMLHttpRequest.prototype.send = function(){
+    var self = this;
+    http.get(this.url, function(res){
+      var d = '';
+      res.on('data', function(c){ d += c; });
+      res.on('end', function(){ self.status = res.statusCode; self.responseText = d; self.onload.call(self); });
+    }).on('error', function(){ self.onerror(); });
+  };
+  h.emit('ready');
+  return { ns: ns, h: h };
+}
+
+function bgSent(h) {
+  return h.sent.filter(function(m){ return 'BG_SGV' in m; }).map(function(m){ return m.BG_SGV; });
+}
+
+function steps(list) {
+  var i = 0;
+  (function next(){ var s = list[i++]; if (s) setTimeout(function(){ s[1](); next(); }, s[0]); })();
+}
+
+function check(ok, what) {
+  console.log((ok ? '  ok   ' : '  FAIL ') + what);
+  if (!ok) process.exitCode = 1;
+}
+
+var run = {
+  push: function() {
+    var state = { reading: { mgdl: 120, mills: Date.now() - 60000, direction: 'Flat' } };
+    var pushedAt = 0, latency = [];
+    state.onSend = function(m){ if ('BG_SGV' in m && pushedAt) { latency.push(Date.now() - pushedAt); pushedAt = 0; } };
+    var polls = [], s = start(state, null, polls), pollsBeforeDrop;
+    var list = [], base = Date.now();
+    // Readings five minutes apart, as a CGM uploads them
+    [1, 2, 3, 4, 5].forEach(function(n){
+      list.push([n === 1 ? 800 : 300, function(){ pushedAt = Date.now(); s.ns.push({ mgdl: 120 + n, mills: base + n * 300000, direction: 'FortyFiveUp' }); }]);
+    });
+    list.push([300, function(){
+      check(latency.length === 5 && Math.max.apply(null, latency) < 500, 'five pushes forwarded, latency ms ' + latency.join(','));
+      check(polls[polls.length - 1] === 15, 'only the safety poll while streaming: ' + polls.join(','));
+      pollsBeforeDrop = polls.length;
+      state.refuse = true;
+      s.ns.dropAll();
+    }]);
+    list.push([500, function(){
+      var after = polls.slice(pollsBeforeDrop);
+      check(after.length > 0 && after[after.length - 1] <= 5, 'dropped stream falls back to the 5 min poll: ' + after.join(','));
+      state.refuse = false;
+    }]);
+    list.push([6000, function(){
+      check(s.ns.count() === 1 && state.authorized === 2, 'stream reconnected and authorized again');
+      pushedAt = Date.now();
+      s.ns.push({ mgdl: 99, mills: base + 6 * 300000, direction: 'Flat' });
+    }]);
+    list.push([300, function(){
+      check(bgSent(s.h).indexOf(99) >= 0, 'push after reconnect forwarded, latency ms ' + latency[latency.length - 1]);
+      process.exit();
+    }]);
+    steps(list);
+  },
+
+  deny: function() { unauthorized('deny', 1000); },
+  none: function() { unauthorized('none', 1000); },
+
+  restart: function() {
+    var now = Math.floor(Date.now() / 1000), ts = now - 60;
+    var extras = { delta: 3, iob: 1.2, cob: 15, raw: 118 };
+    var state = { reading: { mgdl: 120, mills: ts * 1000, direction: 'Flat' } };
+    var stored = { lastBG: { sgv: 120, ts: ts, trend: 4, extras: extras }, bgHistory: [{ sgv: 117, ts: ts - 300 }, { sgv: 120, ts: ts }],
+      followers: [], bgPolledAt: Date.now() };
+    var s = start(state, stored);
+    steps([
+      [1000, function(){ s.ns.push({ mgdl: 120, mills: ts * 1000, direction: 'Flat' }); }],
+      [2500, function(){
+        var saved = JSON.parse(s.h.store.supercgm_state || '{}').lastBG || stored.lastBG;
+        check(bgSent(s.h).length === 0, 'stored reading not resent from the stream');
+        check(JSON.stringify(saved.extras) === JSON.stringify(extras), 'stored extras kept: ' + JSON.stringify(saved.extras));
+        s.ns.push({ mgdl: 126, mills: (ts + 300) * 1000, direction: 'FortyFiveUp' });
+      }],
+      [300, function(){
+        var sent = s.h.sent.filter(function(m){ return m.BG_SGV === 126; });
+        check(sent.length === 1, 'next reading forwarded');
+        process.exit();
+      }]
+    ]);
+  }
+};
+
+function unauthorized(mode, wait) {
+  var state = { auth: mode, reading: { mgdl: 120, mills: Date.now() - 60000, direction: 'Flat' } };
+  var polls = [];
+  var s = start(state, null, polls);
+  steps([
+    [1000, function(){ s.ns.push({ mgdl: 130, mills: Date.now(), direction: 'Flat' }); }],
+    [wait, function(){
+      check(state.authorized >= 1, 'authorize sent');
+      check(bgSent(s.h).indexOf(130) < 0, 'nothing streamed without read access');
+      check(polls.length > 0 && polls.every(function(m){ return m === 5; }), 'polling stays at 5 min: ' + polls.join(','));
+      if (mode === 'deny') {
+        check(s.ns.count() === 0, 'no reconnect after a denial');
+        process.exit();
+      }
+    }],
+    // none: the socket is dropped after STREAM_AUTH_TIMEOUT_MS and retried with backoff
+    [12500, function(){
+      check(state.authorized >= 2, 'unanswered authorize dropped and retried');
+      process.exit();
+    }]
+  ]);
+}
+
+if (typeof WebSocket === 'undefined') {
+  console.log('needs a global WebSocket: run with node --experimental-websocket (node 21+ has it by default)');
+  process.exit(2);
+}
+if (process.argv[2] === '--case') {
+  run[process.argv[3]]();
+} else {
+  var failed = 0;
+  (process.argv.length > 2 ? process.argv.slice(2) : CASES).forEach(function(name){
+    console.log(name);
+    var r = childProcess.spawnSync(process.execPath, process.execArgv.concat([__filename, '--case', name]), { stdio: 'inherit' });
+    if (r.status !== 0) failed++;
+  });
+  console.log(failed ? failed + ' case(s) failed' : 'all cases passed');
+  process.exit(failed ? 1 : 0);
+}
@@ -9,7 +9,15 @@
     { id: 4, name: 'Battery' },
     { id: 5, name: 'Nightscout BG' },
     { id: 6, name: 'Steps' },
-    { id: 7, name: 'Heart Rate' }
+    { id: 7, name: 'Heart Rate' },
+    { id: 8, name: 'Seconds' },
+    { id: 9, name: 'Minutes:Seconds' },
+    { id: 10, name: 'Nightscout BG (person 2)' },
+    { id: 11, name: 'Nightscout BG (person 3)' },
+    { id: 12, name: 'BG delta' },
+    { id: 13, name: 'Insulin on board (IOB)' },
+    { id: 14, name: 'Carbs on board (COB)' },
+    { id: 15, name: 'Raw BG' }
   ];
 
   var Presets = [
@@ -112,9 +120,10 @@
         rows: Math.max(1, Math.min(5, parseInt(p.get('rows')||'5',10))),
         bw: (p.get('bw') === '1'),
         pebble2: (p.get('pebble2') === '1'),
-        platform: p.get('platform') || ''
+        platform: p.get('platform') || '',
+        bgPoll: p.get('bgPoll') || ''
       };
-    } catch(e) { return { rows:5, bw:false, pebble2:false, platform:'' }; }
+    } catch(e) { return { rows:5, bw:false, pebble2:false, platform:'', bgPoll:'' }; }
   }
   var params = getParams();
   if (params.pebble2) params.bw = true;
@@ -365,7 +374,7 @@
 
   function updateBGSectionVisibility() {
     var rows = collectRows();
-    var anyBG = rows.some(function(r){ return r.type === 5; });
+    var anyBG = rows.some(function(r){ return r.type === 5 || (r.type >= 10 && r.type <= 15); });
     var nsSection = byId('bg-section');
     if (nsSection) nsSection.style.display = anyBG ? '' : 'none';
   }
@@ -437,16 +446,26 @@
     }
     var payload = {
       showLeadingZero: byId('leadingZero').checked,
+      idleMode: byId('idleMode').checked,
       dateFormat: parseInt(document.querySelector('input[name="datefmt"]:checked').value,10),
       weekdayLang: parseInt(document.querySelector('input[name="wdlang"]:checked').value,10),
       tempUnit: document.querySelector('input[name="tempunit"]:checked').value,
       weatherIntervalMin: parseInt(byId('weatherInt').value,10),
       bgFetchIntervalMin: parseInt(byId('bgFetchInt').value,10),
+      bgStreaming: byId('bgStreaming').checked,
+      bgAdaptive: byId('bgAdaptive').checked,
+      bgPollMinMin: parseInt(byId('bgPollMin').value,10),
+      bgPollMaxMin: parseInt(byId('bgPollMax').value,10),
       bgUrl: byId('bgUrl').value.trim(),
+      followers: [1, 2].map(function(n){
+        return { url: byId('follow' + n + 'Url').value.trim(), tag: byId('follow' + n + 'Tag').value.trim().toUpperCase() };
+      }),
       bgTimeoutMin: parseInt(byId('bgTimeout').value,10),
       bgUnit: document.querySelector('input[name="bgunit"]:checked').value,
       low: parseInt(byId('low').value,10),
       high: parseInt(byId('high').value,10),
+      bgUrgentLow: parseInt(byId('urgentLow').value,10),
+      bgAlertSnoozeMin: parseInt(byId('alertSnooze').value,10),
       colors: {
         low: colLow,
         in: colIn,
@@ -487,16 +506,28 @@
       if (cfg && cfg.preset) selectPreset(cfg.preset);
       cfg = applyPebble2Colors(cfg);
       byId('leadingZero').checked = !!cfg.showLeadingZero;
+      byId('idleMode').checked = !!cfg.idleMode;
       document.querySelector('input[name="datefmt"][value="'+(cfg.dateFormat||0)+'"]').checked = true;
       document.querySelector('input[name="wdlang"][value="'+(cfg.weekdayLang||0)+'"]').checked = true;
       document.querySelector('input[name="tempunit"][value="'+(cfg.tempUnit||'C')+'"]').checked = true;
       byId('weatherInt').value = cfg.weatherIntervalMin || 30;
       byId('bgUrl').value = cfg.bgUrl || '';
+      [1, 2].forEach(function(n){
+        var f = (cfg.followers || [])[n - 1] || {};
+        byId('follow' + n + 'Url').value = f.url || '';
+        byId('follow' + n + 'Tag').value = f.tag || (n === 1 ? 'B' : 'C');
+      });
       byId('bgTimeout').value = cfg.bgTimeoutMin || 20;
       byId('bgFetchInt').value = cfg.bgFetchIntervalMin || 5;
+      byId('bgStreaming').checked = !!cfg.bgStreaming;
+      byId('bgAdaptive').checked = !!cfg.bgAdaptive;
+      byId('bgPollMin').value = cfg.bgPollMinMin || 1;
+      byId('bgPollMax').value = cfg.bgPollMaxMin || 10;
       document.querySelector('input[name="bgunit"][value="'+(cfg.bgUnit||'mgdl')+'"]').checked = true;
       byId('low').value = cfg.low || 80;
       byId('high').value = cfg.high || 180;
+      byId('urgentLow').value = (typeof cfg.bgUrgentLow === 'number') ? cfg.bgUrgentLow : 55;
+      byId('alertSnooze').value = cfg.bgAlertSnoozeMin || 30;
       var applyColorValue = function(id, value) {
         var input = byId(id);
         var sel = byId(id + 'Fallback');
@@ -534,6 +565,10 @@
       if (e.target && (e.target.classList.contains('row-type'))) updateBGSectionVisibility();
     });
     updateBGSectionVisibility();
+    if (params.bgPoll) {
+      byId('bgPollStatus').textContent = 'Currently polling every ' + params.bgPoll;
+      byId('bgPollStatus').hidden = false;
+    }
     byId('save').onclick=save;
     byId('cancel').onclick=cancel;
     var reloadBtn = byId('reload');